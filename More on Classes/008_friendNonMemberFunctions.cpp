@@ -209,8 +209,50 @@
         - Be cautious when adding new members to the public interface of an existing class, as every function (even trivial ones) adds some level of clutter and complexity. In the case of Accumulator above, it’s totally reasonable to have an access function to get the current accumulated value. In more complex cases, it may be preferable to use friendship instead of adding many new access functions to the interface of a class.
 
 
+    8. An Accumulator shared by many threads : calling add() from several threads at once on the Accumulator above is a data race (undefined behavior). Making m_value a std::atomic fixes that, but every add() then needs the one cache line holding m_value. Each core has to take that line from the core that wrote it last (cache line ping-pong), so adds from 8 threads end up slower than adds from 1.
+
+        - Giving each thread its own counter in a plain array doesn't help either : 8 counters of 8 bytes share a single 64 byte cache line, so the cores still fight over the line even though they never touch the same counter (false sharing).
+
+        - ShardedAccumulator gives each thread its own slot, and each slot is alignas(64) so it fills a whole cache line :
+
+            add(value)      fetch_add on the calling thread's slot, nobody else is normally using that line, and it never waits on other threads (wait-free)
+            exact()         adds up all of the slots : every add() that happened before the call is counted, exactly once
+            approximate()   returns a cached total, refreshed by exact() at most once per refresh interval, so frequent readers cost one load and don't pull the writers' cache lines. Only that refresh writes the cache (one reader at a time), exact() itself just returns the total, so a slow exact() can't put an older total back
+
+        - The first add() of a thread gives it a number : the smallest one no other live thread holds, and the thread gives it back when it exits. So the numbers of the live threads stay below the number of live threads, and as long as there are no more threads alive than slots (slots start at 2x the hardware threads), each live thread has a slot of its own. With more threads, they wrap around and share slots : that is still correct, the fetch_add handles it, it's only slower.
+
+        - print() is still a friend, and prints exact().
+
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
 class Accumulator
 {
 private:
@@ -230,12 +272,200 @@ void print(const Accumulator& accumulator)
     std::cout << accumulator.m_value;
 }
 
+class ShardedAccumulator
+{
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<long long> m_value { 0 };
+    };
+
+    std::unique_ptr<Slot[]> m_slots {};
+    unsigned m_mask {};
+
+    // for approximate()
+    std::chrono::steady_clock::duration m_refreshInterval {};
+    mutable std::atomic<long long> m_cached { 0 };
+    mutable std::atomic<std::chrono::steady_clock::rep> m_refreshedAt { 0 };
+    mutable std::atomic_flag m_refreshing {};
+
+    // The smallest number not held by a live thread. Taken once per thread, so a mutex is fine
+    class ThreadNumber
+    {
+        struct Pool
+        {
+            std::mutex m_mutex {};
+            std::vector<unsigned> m_free {};    // min heap of numbers given back
+            unsigned m_next { 0 };
+        };
+
+        static Pool& pool()
+        {
+            static Pool pool {};
+            return pool;
+        }
+
+        static unsigned take()
+        {
+            Pool& numbers { pool() };
+            std::lock_guard lock { numbers.m_mutex };
+            if (numbers.m_free.empty())
+                return numbers.m_next++;
+
+            std::pop_heap(numbers.m_free.begin(), numbers.m_free.end(), std::greater<> {});
+            unsigned number { numbers.m_free.back() };
+            numbers.m_free.pop_back();
+            return number;
+        }
+
+        unsigned m_number { take() };
+
+    public:
+        ThreadNumber() = default;
+        ThreadNumber(const ThreadNumber&) = delete;
+        ThreadNumber& operator=(const ThreadNumber&) = delete;
+
+        // the thread is exiting
+        ~ThreadNumber()
+        {
+            Pool& numbers { pool() };
+            std::lock_guard lock { numbers.m_mutex };
+            numbers.m_free.push_back(m_number);
+            std::push_heap(numbers.m_free.begin(), numbers.m_free.end(), std::greater<> {});
+        }
+
+        unsigned get() const { return m_number; }
+    };
+
+    static unsigned threadNumber()
+    {
+        thread_local const ThreadNumber number {};
+        return number.get();
+    }
+
+    static unsigned defaultSlotCount()
+    {
+        return 2 * std::max(1u, std::thread::hardware_concurrency());
+    }
+
+public:
+    explicit ShardedAccumulator(unsigned slotCount = defaultSlotCount(), std::chrono::steady_clock::duration refreshInterval = std::chrono::milliseconds { 1 })
+        : m_refreshInterval { refreshInterval }
+    {
+        unsigned slots { 1 };
+        while (slots < slotCount)
+            slots *= 2;
+
+        m_slots = std::make_unique<Slot[]>(slots);
+        m_mask = slots - 1;
+    }
+
+    void add(long long value)
+    {
+        m_slots[threadNumber() & m_mask].m_value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    long long exact() const
+    {
+        long long total { 0 };
+        for (unsigned slot = 0; slot <= m_mask; ++slot)
+            total += m_slots[slot].m_value.load(std::memory_order_acquire);
+
+        return total;
+    }
+
+    long long approximate() const
+    {
+        auto now { std::chrono::steady_clock::now().time_since_epoch().count() };
+        if (now - m_refreshedAt.load(std::memory_order_relaxed) > m_refreshInterval.count()
+            && !m_refreshing.test_and_set(std::memory_order_acquire)) // one reader refreshes, the others keep the cached total
+        {
+            m_cached.store(exact(), std::memory_order_relaxed);
+            m_refreshedAt.store(now, std::memory_order_relaxed);
+            m_refreshing.clear(std::memory_order_release);
+        }
+
+        return m_cached.load(std::memory_order_relaxed);
+    }
+
+    unsigned getSlotCount() const { return m_mask + 1; }
+
+    friend void print(const ShardedAccumulator& accumulator);
+};
+
+void print(const ShardedAccumulator& accumulator)
+{
+    std::cout << accumulator.exact();
+}
+
+// Run body(thread) on threadCount threads at once, return the time taken in ms
+template <typename Body>
+double runThreads(int threadCount, Body body)
+{
+    Timer t;
+    std::vector<std::thread> threads {};
+    for (int thread = 0; thread < threadCount; ++thread)
+        threads.emplace_back(body, thread);
+    for (auto& thread : threads)
+        thread.join();
+
+    return t.elapsed() / 1e6;
+}
+
 int main()
 {
     Accumulator acc{};
     acc.add(5); // add 5 to the accumulator
 
     print(acc); // call the print() non-member function
+    std::cout << '\n';
+
+    // the same hot counter, hit by every thread
+    constexpr int threadCount { 4 };
+    constexpr int addsPerThread { 5000000 };
+
+    std::atomic<long long> shared { 0 };
+    double sharedMs { runThreads(threadCount, [&](int) {
+        for (int i = 0; i < addsPerThread; ++i)
+            shared.fetch_add(1, std::memory_order_relaxed);
+    }) };
+
+    std::atomic<long long> packed[threadCount] {}; // one per thread, but all on the same cache line
+    double packedMs { runThreads(threadCount, [&](int thread) {
+        for (int i = 0; i < addsPerThread; ++i)
+            packed[thread].fetch_add(1, std::memory_order_relaxed);
+    }) };
+
+    ShardedAccumulator sharded {};
+    double shardedMs { runThreads(threadCount, [&](int) {
+        for (int i = 0; i < addsPerThread; ++i)
+            sharded.add(1);
+    }) };
+
+    std::cout << threadCount << " threads x " << addsPerThread << " adds : one atomic " << sharedMs << " ms, packed atomics " << packedMs
+              << " ms, ShardedAccumulator (" << sharded.getSlotCount() << " slots) " << shardedMs << " ms\n";
+    std::cout << "exact : ";
+    print(sharded);
+    std::cout << " (expected " << static_cast<long long>(threadCount) * addsPerThread << ")\n";
+
+    // a monitoring thread reading the counter all the time, while the others add
+    std::atomic<bool> done { false };
+    long long reads { 0 };
+    long long lastSeen { 0 };
+    std::thread reader { [&] {
+        while (!done.load(std::memory_order_relaxed))
+        {
+            lastSeen = sharded.approximate();
+            ++reads;
+        }
+    } };
+    runThreads(threadCount, [&](int) {
+        for (int i = 0; i < addsPerThread; ++i)
+            sharded.add(1);
+    });
+    done = true;
+    reader.join();
+    std::cout << reads << " approximate() reads while adding, the last one saw " << lastSeen << ", exact : " << sharded.exact() << '\n';
 
     return 0;
 }
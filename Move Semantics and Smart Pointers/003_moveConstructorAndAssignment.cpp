@@ -247,6 +247,81 @@
         
         - You can implement the move constructor and move assignment using your own swap function, as long as your swap member function does not call the move constructor or move assignment. 
 
+    11. Growing a DynamicArray (push_back, reserve and std::move_if_noexcept) :
+
+        - A fixed-size DynamicArray can only "grow" by building a new, bigger array and deep copying every element into it. If we append one element at a time, that is a full copy per append (O(n^2) in total).
+
+        - Instead we separate the length (number of live elements) from the capacity (number of slots allocated). The storage is raw memory (::operator new), and elements are created in it with placement new and destroyed with std::destroy_n, so unused slots hold no objects at all.
+
+        - When push_back/emplace_back finds the array full, the capacity is grown geometrically (doubled). Every element is then relocated at most a constant number of times on average, so appending n elements costs amortized O(1) per element.
+
+        - Relocating the old elements into the new block uses std::move_if_noexcept (see Exceptions/010_moveifnoexcept.cpp) :
+
+            = If T's move constructor is noexcept, the elements are moved (cheap, and cannot fail half way).
+            = Otherwise they are copied, so if a copy throws, the old block is still intact and the array is unchanged (strong exception guarantee). This is exactly what std::vector does.
+
+        - reserve(n) grows the capacity up front when the final size is known, and shrink_to_fit() gives back unused capacity.
+
+            DynamicArray<int> arr;
+            arr.reserve(1000000);          // one allocation
+            for (int i = 0; i < 1000000; ++i)
+                arr.push_back(i);          // no reallocation, no copies
+
+        - The new element in emplace_back is constructed before the old elements are relocated, so arr.push_back(arr[0]) is safe even when it triggers a reallocation.
+
+    12. Trivially relocatable types :
+
+        - Relocating an object means "move construct it at a new address, then destroy the old one". For many types that pair of calls does nothing more than copy the bytes: int, double, a struct of ints, but also a class that only owns a heap pointer (like Auto_ptr3 or Resource handles) -- the pointer value is copied and the old object's destructor would have done nothing after the move.
+
+        - For such types the whole relocation loop can be replaced by a single memcpy, or better, a single std::realloc, which can often grow the block in place (or, for big blocks, remap the pages) without copying anything.
+
+        - The compiler can prove this for trivially copyable types (std::is_trivially_copyable), but not for a class with a user-written move constructor and destructor, even if it is relocatable in practice. So we use an opt-in trait :
+
+            template <typename T>
+            struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+            // Texture only owns a pointer, copying its bytes is a valid move
+            template <>
+            struct is_trivially_relocatable<Texture> : std::true_type {};
+
+        - Be careful what you opt in. A type that stores a pointer into itself is NOT relocatable : libstdc++'s std::string points at its own small buffer for short strings, so its bytes cannot just be copied to a new address.
+
+        - DynamicArray keeps its storage in std::malloc'd memory so that the relocatable path can use std::realloc, while every other type still goes through std::move_if_noexcept one element at a time.
+
+    13. Plugging in a memory resource (arena, pool, huge pages) :
+
+        - Where the elements live is a separate decision from how the container manages them. C++17's std::pmr::memory_resource is an abstract class with allocate(bytes, alignment) and deallocate(p, bytes, alignment), so a container can take a memory_resource* and be handed any allocation strategy at run time, without changing its type (unlike an allocator template parameter, which makes DynamicArray<int, A> and DynamicArray<int, B> different types).
+
+            std::pmr::monotonic_buffer_resource arena { buffer, sizeof(buffer) };
+            DynamicArray<int> scratch(&arena);
+
+        - Useful resources :
+
+            = bump arena : std::pmr::monotonic_buffer_resource. Allocating is moving a pointer forward, deallocate does nothing, and everything is released at once when the arena is destroyed. Perfect for per-request scratch arrays.
+            = size-class pool : std::pmr::unsynchronized_pool_resource (or synchronized_pool_resource, for several threads). Keeps free lists of blocks per size class, so freed blocks are reused without going back to the heap.
+            = huge pages : HugePageResource below. Hands out memory in 2 MB aligned blocks and asks the kernel (madvise(MADV_HUGEPAGE)) to back it with 2 MB pages, so a big array needs 512x fewer TLB entries.
+
+        - DynamicArray(int size, std::pmr::memory_resource* resource = nullptr). A null resource means the C heap (std::malloc), which keeps the std::realloc fast path of note 12. With any other resource, growing a trivially relocatable array is one allocate + one memcpy + one deallocate.
+
+        - A copy is made on the C heap unless a resource is passed to the copy constructor (a scratch array copied out of an arena usually has to outlive the arena). The move constructor takes the resource along with the elements, but move assignment keeps the resource of the array assigned to (the std::pmr rule, same as IntArray and Array<T>) : the buffer only changes hands when both resources compare equal, otherwise the elements are moved one by one into our own resource, so that move assignment can throw.
+
+    14. Small buffer optimization (SmallDynamicArray<T, N>) :
+
+        - Most arrays in a program are short, yet DynamicArray allocates on the heap for even one element. SmallDynamicArray<T, N> keeps room for N elements inside the object itself, and only allocates once it grows past N (it "spills" to the heap). std::string does the same for short strings.
+
+            SmallDynamicArray<int, 16> ids;   // no allocation
+            for (int i = 0; i < 16; ++i)
+                ids.push_back(i);             // still no allocation
+            ids.push_back(16);                // spills : one heap block of 32, the 16 elements are relocated
+
+        - The price is that move semantics get more interesting :
+
+            = heap state : the move constructor steals the pointer, exactly like DynamicArray.
+            = inline state : there is no pointer to steal, the elements live inside the source object. They have to be moved one by one into our own inline buffer (so a move costs O(N), not O(1)), and the source is left empty.
+
+        - The element pointer (_arr) points into the object itself while inline, so copies and moves must never copy _arr blindly. For the same reason SmallDynamicArray is not trivially relocatable (note 12), just like std::string.
+
+        - The move constructor is noexcept only if T's move constructor is, because moving inline elements calls it.
 
 */
 
@@ -312,34 +387,201 @@ public:
 };
 
 #include <algorithm>
+#include <cstddef>      // for std::max_align_t
+#include <cstdint>      // for std::uintptr_t
+#include <cstdlib>      // for std::malloc, std::realloc, std::free
+#include <cstring>      // for std::memcpy
+#include <limits>       // for std::numeric_limits
+#include <memory>       // for std::uninitialized_copy_n, std::destroy_n
+#include <memory_resource>
+#include <new>          // for placement new, std::bad_alloc
+#include <stdexcept>    // for std::length_error
+#include <type_traits>
+#include <utility>      // for std::move_if_noexcept, std::forward
+
+// Opt-in trait (see note 12) : specialize it to std::true_type for a type whose
+// relocation (move to a new address + destroy the old object) is just a byte copy.
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
 
 template <typename T>
 class DynamicArray
 {
+    std::pmr::memory_resource * _resource; // nullptr : the C heap (see note 13)
     T * _arr;
     int _len;
+    int _cap;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "std::malloc storage is not aligned enough for T");
+
+    T * allocate(int cap) const
+    {
+        if (cap <= 0)
+            return nullptr;
+
+        if (_resource)
+            return static_cast<T *>(_resource->allocate(sizeof(T) * cap, alignof(T)));
+
+        void * arr = std::malloc(sizeof(T) * cap);
+        if (!arr)
+            throw std::bad_alloc{};
+
+        return static_cast<T *>(arr);
+    }
+
+    void deallocate(T * arr, int cap) const
+    {
+        if (_resource)
+        {
+            if (arr)
+                _resource->deallocate(arr, sizeof(T) * cap, alignof(T));
+        }
+        else
+        {
+            std::free(arr);
+        }
+    }
+
+    // Fast path for trivially relocatable T : the bytes are the objects, so one
+    // std::realloc relocates every element (in place, if the block can be extended).
+    // A memory resource can't resize a block, so there it is one memcpy instead.
+    T * reallocateBytes(int cap)
+    {
+        if (_resource)
+        {
+            T * fresh = allocate(cap);
+            if (_len > 0)
+                std::memcpy(static_cast<void *>(fresh), static_cast<const void *>(_arr), sizeof(T) * _len);
+            deallocate(_arr, _cap);
+            return fresh;
+        }
+
+        if (cap <= 0)
+        {
+            std::free(_arr);
+            return nullptr;
+        }
+
+        void * fresh = std::realloc(static_cast<void *>(_arr), sizeof(T) * cap);
+        if (!fresh)
+            throw std::bad_alloc{};
+
+        return static_cast<T *>(fresh);
+    }
+
+    // Copy or move (see std::move_if_noexcept) the live elements into fresh storage.
+    // If a copy throws, fresh storage is released and *this is left untouched.
+    static void relocate(T * from, int len, T * to)
+    {
+        int i = 0;
+        try
+        {
+            for (; i < len; ++i)
+                ::new (static_cast<void *>(to + i)) T(std::move_if_noexcept(from[i]));
+        }
+        catch (...)
+        {
+            std::destroy_n(to, i);
+            throw;
+        }
+    }
+
+    void reallocate(int newCap)
+    {
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            _arr = reallocateBytes(newCap);
+            _cap = newCap;
+            return;
+        }
+
+        T * fresh = allocate(newCap);
+        try
+        {
+            relocate(_arr, _len, fresh);
+        }
+        catch (...)
+        {
+            deallocate(fresh, newCap);
+            throw;
+        }
+
+        std::destroy_n(_arr, _len);
+        deallocate(_arr, _cap);
+        _arr = fresh;
+        _cap = newCap;
+    }
+
+    // nullptr (the C heap) only matches itself, resources compare with is_equal()
+    bool sameResource(std::pmr::memory_resource * other) const
+    {
+        if (!_resource || !other)
+            return _resource == other;
+
+        return *_resource == *other;
+    }
+
+    // doubles, but stops at the largest int (_cap * 2 would overflow once _cap reaches 2^30)
+    int grownCapacity() const
+    {
+        constexpr int maxCap = std::numeric_limits<int>::max();
+        if (_cap == maxCap)
+            throw std::length_error{"DynamicArray is full"};
+
+        return _cap == 0 ? 1 : (_cap > maxCap / 2 ? maxCap : _cap * 2);
+    }
 
     public:
 
-    DynamicArray(int size) : _arr{new T[size]} , _len{size}
+    DynamicArray() : _resource{nullptr} , _arr{nullptr} , _len{0} , _cap{0}
+    {
+
+    }
+
+    explicit DynamicArray(std::pmr::memory_resource * resource) : _resource{resource} , _arr{nullptr} , _len{0} , _cap{0}
     {
 
     }
 
+    DynamicArray(int size, std::pmr::memory_resource * resource = nullptr)
+    : _resource{resource} , _arr{allocate(size)} , _len{size} , _cap{size}
+    {
+        try
+        {
+            std::uninitialized_default_construct_n(_arr, _len);
+        }
+        catch (...)
+        {
+            deallocate(_arr, _cap);
+            throw;
+        }
+    }
+
     ~DynamicArray()
     { 
-        delete [] _arr;
+        std::destroy_n(_arr, _len);
+        deallocate(_arr, _cap);
     }
 
-    // copy constructor
-    DynamicArray(const DynamicArray& copy) :
-    _len{copy._len}
+    // copy constructor (on the C heap, unless told otherwise)
+    DynamicArray(const DynamicArray& copy, std::pmr::memory_resource * resource = nullptr) :
+    _resource{resource} , _arr{allocate(copy._len)} , _len{copy._len} , _cap{copy._len}
     {
-        _arr = new T[_len];
-        std::copy_n(copy._arr , _len , _arr);
+        try
+        {
+            std::uninitialized_copy_n(copy._arr , _len , _arr);
+        }
+        catch (...)
+        {
+            deallocate(_arr, _cap);
+            throw;
+        }
     }
 
-    // copy assignment
+    // copy assignment (copy and swap, see note 10), keeps our own resource
     DynamicArray& operator=(const DynamicArray &copy)
     {
         if(this == &copy)
@@ -347,25 +589,24 @@ class DynamicArray
             return *this;
         }
 
-        delete [] _arr;
-        _len = copy._len;
-        _arr = new T[_len];
-
-        std::copy_n(copy._arr , _len , _arr);
+        DynamicArray temp{copy, _resource};
+        swap(temp);
 
         return *this;
     }
 
     // move constructor
     DynamicArray(DynamicArray &&copy) noexcept
-    : _arr{copy._arr} , _len{copy._len}
+    : _resource{copy._resource} , _arr{copy._arr} , _len{copy._len} , _cap{copy._cap}
     {
         copy._len = 0;
+        copy._cap = 0;
         copy._arr = nullptr;
     }
 
-    // move assignment
-    DynamicArray & operator=(DynamicArray && copy) noexcept
+    // move assignment, keeps our own resource (the std::pmr rule) : the buffer can only change hands
+    // if it goes back to the same resource, otherwise the elements are moved one by one into ours
+    DynamicArray & operator=(DynamicArray && copy)
     {
 
         if(this == &copy)
@@ -373,23 +614,140 @@ class DynamicArray
             return *this;
         }
 
-        delete [] _arr;
+        if (!sameResource(copy._resource))
+        {
+            DynamicArray temp{_resource};
+            temp.reserve(copy._len);
+            for (int i = 0; i < copy._len; ++i)
+                temp.emplace_back(std::move(copy._arr[i]));
+            swap(temp);
+
+            return *this;
+        }
+
+        std::destroy_n(_arr, _len);
+        deallocate(_arr, _cap);
 
         _len = copy._len;
+        _cap = copy._cap;
         _arr = copy._arr;
 
         copy._len = 0;
+        copy._cap = 0;
         copy._arr = nullptr;
 
         return *this;
     }
 
+    // our own swap, which never calls the move constructor or move assignment
+    void swap(DynamicArray &other) noexcept
+    {
+        std::swap(_resource, other._resource);
+        std::swap(_arr, other._arr);
+        std::swap(_len, other._len);
+        std::swap(_cap, other._cap);
+    }
+
+    template <typename... Args>
+    T & emplace_back(Args&&... args)
+    {
+        if (_len < _cap)
+        {
+            ::new (static_cast<void *>(_arr + _len)) T(std::forward<Args>(args)...);
+            return _arr[_len++];
+        }
+
+        // Construct the new element first: args may refer to an element of this array.
+        int newCap = grownCapacity();
+
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            alignas(T) unsigned char element[sizeof(T)];
+            T * value = ::new (static_cast<void *>(element)) T(std::forward<Args>(args)...);
+            try
+            {
+                _arr = reallocateBytes(newCap);
+            }
+            catch (...)
+            {
+                value->~T();
+                throw;
+            }
+
+            // relocate the new element into its slot, its old bytes are simply forgotten
+            std::memcpy(static_cast<void *>(_arr + _len), element, sizeof(T));
+            _cap = newCap;
+            return _arr[_len++];
+        }
+
+        T * fresh = allocate(newCap);
+        ::new (static_cast<void *>(fresh + _len)) T(std::forward<Args>(args)...);
+        try
+        {
+            relocate(_arr, _len, fresh);
+        }
+        catch (...)
+        {
+            fresh[_len].~T();
+            deallocate(fresh, newCap);
+            throw;
+        }
+
+        std::destroy_n(_arr, _len);
+        deallocate(_arr, _cap);
+        _arr = fresh;
+        _cap = newCap;
+        return _arr[_len++];
+    }
+
+    void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back()
+    {
+        _arr[--_len].~T();
+    }
+
+    void clear() noexcept
+    {
+        std::destroy_n(_arr, _len);
+        _len = 0;
+    }
+
+    void reserve(int newCap)
+    {
+        if (newCap > _cap)
+            reallocate(newCap);
+    }
+
+    void shrink_to_fit()
+    {
+        if (_cap > _len)
+            reallocate(_len);
+    }
 
     int getLength() const
     {
         return _len;
     }
 
+    int getCapacity() const
+    {
+        return _cap;
+    }
+
+    std::pmr::memory_resource * getResource() const
+    {
+        return _resource;
+    }
+
     T & operator[](int index)
     {
         return _arr[index];
@@ -402,6 +760,317 @@ class DynamicArray
 
 };
 
+#ifdef __linux__
+#include <sys/mman.h>   // for mmap, munmap, madvise
+#endif
+
+// Memory in whole 2 MB blocks aligned to 2 MB, so the kernel can map each one with a
+// single huge page (see note 13). Meant for a few big arrays, not many small ones.
+class HugePageResource : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t pageSize { 2 * 1024 * 1024 };
+
+private:
+    static std::size_t roundUp(std::size_t bytes)
+    {
+        return bytes == 0 ? pageSize : (bytes + pageSize - 1) / pageSize * pageSize;
+    }
+
+    void * do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (alignment > pageSize)
+            throw std::bad_alloc{};
+
+        std::size_t size { roundUp(bytes) };
+#ifdef __linux__
+        // mmap only promises 4 KB alignment : map one extra page, then unmap the unaligned head and tail
+        void * raw = mmap(nullptr, size + pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            throw std::bad_alloc{};
+
+        auto begin { reinterpret_cast<std::uintptr_t>(raw) };
+        auto aligned { (begin + pageSize - 1) & ~(pageSize - 1) };
+        if (aligned > begin)
+            munmap(raw, aligned - begin);
+        if (std::size_t tail { begin + pageSize - aligned }; tail > 0)
+            munmap(reinterpret_cast<void *>(aligned + size), tail);
+
+#ifdef MADV_HUGEPAGE
+        madvise(reinterpret_cast<void *>(aligned), size, MADV_HUGEPAGE);
+#endif
+        return reinterpret_cast<void *>(aligned);
+#else
+        return ::operator new(size, std::align_val_t{ pageSize });
+#endif
+    }
+
+    void do_deallocate(void * p, std::size_t bytes, std::size_t) override
+    {
+#ifdef __linux__
+        munmap(p, roundUp(bytes));
+#else
+        ::operator delete(p, std::align_val_t{ pageSize });
+#endif
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+template <typename T, int N>
+class SmallDynamicArray
+{
+    static_assert(N > 0, "use DynamicArray when there is no inline storage");
+
+    alignas(T) unsigned char _inline[sizeof(T) * N];
+    T * _arr;   // _inline while the elements fit, a std::malloc'd block after that
+    int _len;
+    int _cap;
+
+    T * inlineData()
+    {
+        return reinterpret_cast<T *>(_inline);
+    }
+
+    bool isInline() const
+    {
+        return _arr == reinterpret_cast<const T *>(_inline);
+    }
+
+    static T * allocate(int cap)
+    {
+        void * arr = std::malloc(sizeof(T) * cap);
+        if (!arr)
+            throw std::bad_alloc{};
+
+        return static_cast<T *>(arr);
+    }
+
+    // Move (or copy, see std::move_if_noexcept) our elements into fresh storage, which is inline or on the heap.
+    void relocateTo(T * fresh, int newCap)
+    {
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            if (_len > 0)
+                std::memcpy(static_cast<void *>(fresh), static_cast<const void *>(_arr), sizeof(T) * _len);
+        }
+        else
+        {
+            int i = 0;
+            try
+            {
+                for (; i < _len; ++i)
+                    ::new (static_cast<void *>(fresh + i)) T(std::move_if_noexcept(_arr[i]));
+            }
+            catch (...)
+            {
+                std::destroy_n(fresh, i);
+                throw;
+            }
+            std::destroy_n(_arr, _len);
+        }
+
+        if (!isInline())
+            std::free(_arr);
+        _arr = fresh;
+        _cap = newCap;
+    }
+
+    void growTo(int newCap)
+    {
+        T * fresh = allocate(newCap);
+        try
+        {
+            relocateTo(fresh, newCap);
+        }
+        catch (...)
+        {
+            std::free(fresh);
+            throw;
+        }
+    }
+
+    // Take other's elements : steal its heap block, or move its inline elements one by one.
+    // We must be empty and inline before this is called.
+    void takeFrom(SmallDynamicArray &other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (other.isInline())
+        {
+            std::uninitialized_move_n(other._arr, other._len, _arr);
+            _len = other._len;
+            std::destroy_n(other._arr, other._len);
+        }
+        else
+        {
+            _arr = other._arr;
+            _len = other._len;
+            _cap = other._cap;
+            other._arr = other.inlineData();
+            other._cap = N;
+        }
+        other._len = 0;
+    }
+
+    void release() noexcept
+    {
+        std::destroy_n(_arr, _len);
+        if (!isInline())
+            std::free(_arr);
+        _arr = inlineData();
+        _len = 0;
+        _cap = N;
+    }
+
+    public:
+
+    SmallDynamicArray() : _arr{inlineData()} , _len{0} , _cap{N}
+    {
+
+    }
+
+    explicit SmallDynamicArray(int size) : SmallDynamicArray()
+    {
+        reserve(size);
+        std::uninitialized_default_construct_n(_arr, size);
+        _len = size;
+    }
+
+    ~SmallDynamicArray()
+    {
+        release();
+    }
+
+    // copy constructor
+    SmallDynamicArray(const SmallDynamicArray &copy) : SmallDynamicArray()
+    {
+        reserve(copy._len);
+        std::uninitialized_copy_n(copy._arr, copy._len, _arr);
+        _len = copy._len;
+    }
+
+    // copy assignment : copy first, so a throwing copy leaves *this untouched
+    SmallDynamicArray & operator=(const SmallDynamicArray &copy)
+    {
+        if (this == &copy)
+        {
+            return *this;
+        }
+
+        SmallDynamicArray temp{copy};
+        *this = std::move(temp);
+
+        return *this;
+    }
+
+    // move constructor
+    SmallDynamicArray(SmallDynamicArray &&copy) noexcept(std::is_nothrow_move_constructible_v<T>)
+    : SmallDynamicArray()
+    {
+        takeFrom(copy);
+    }
+
+    // move assignment
+    SmallDynamicArray & operator=(SmallDynamicArray &&copy) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this == &copy)
+        {
+            return *this;
+        }
+
+        release();
+        takeFrom(copy);
+
+        return *this;
+    }
+
+    template <typename... Args>
+    T & emplace_back(Args&&... args)
+    {
+        if (_len == _cap)
+        {
+            // build the element first, args may refer to one of our elements
+            T value(std::forward<Args>(args)...);
+            constexpr int maxCap = std::numeric_limits<int>::max();
+            if (_cap == maxCap)
+                throw std::length_error{"SmallDynamicArray is full"};
+            growTo(_cap > maxCap / 2 ? maxCap : _cap * 2);
+            ::new (static_cast<void *>(_arr + _len)) T(std::move(value));
+        }
+        else
+        {
+            ::new (static_cast<void *>(_arr + _len)) T(std::forward<Args>(args)...);
+        }
+        return _arr[_len++];
+    }
+
+    void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back()
+    {
+        _arr[--_len].~T();
+    }
+
+    void clear() noexcept
+    {
+        std::destroy_n(_arr, _len);
+        _len = 0;
+    }
+
+    void reserve(int newCap)
+    {
+        if (newCap > _cap)
+            growTo(newCap);
+    }
+
+    // move back inline if the elements fit again, otherwise trim the heap block
+    void shrink_to_fit()
+    {
+        if (isInline() || _len == _cap)
+            return;
+
+        if (_len <= N)
+            relocateTo(inlineData(), N);
+        else
+            growTo(_len);
+    }
+
+    int getLength() const
+    {
+        return _len;
+    }
+
+    int getCapacity() const
+    {
+        return _cap;
+    }
+
+    bool isSmall() const
+    {
+        return isInline();
+    }
+
+    T & operator[](int index)
+    {
+        return _arr[index];
+    }
+
+    const T & operator[](int index) const
+    {
+        return _arr[index];
+    }
+};
+
 #include <chrono>
 
 class Timer
@@ -423,6 +1092,48 @@ public:
     }
 };
 
+// A user type that only owns a heap pointer, like Auto_ptr3 : moving it is
+// copying the pointer, so it is safe to opt in to the realloc fast path.
+class Texture
+{
+    int * m_pixels {};
+
+public:
+    Texture() : m_pixels{ new int[16]{} } {}
+    ~Texture() { delete[] m_pixels; }
+
+    Texture(const Texture& copy) : m_pixels{ new int[16] } { std::copy_n(copy.m_pixels, 16, m_pixels); }
+    Texture& operator=(const Texture&) = delete;
+
+    Texture(Texture&& texture) noexcept : m_pixels{ texture.m_pixels } { texture.m_pixels = nullptr; }
+    Texture& operator=(Texture&&) = delete;
+};
+
+template <>
+struct is_trivially_relocatable<Texture> : std::true_type {};
+
+// Time a single reallocation of a full array of count elements (best of a few runs).
+template <typename T>
+double reallocationCost(int count)
+{
+    double best {};
+    for (int run = 0; run < 5; ++run)
+    {
+        DynamicArray<T> arr;
+        arr.reserve(count);
+        for (int i = 0; i < count; ++i)
+            arr.emplace_back();
+
+        Timer t;
+        arr.reserve(count * 2);
+        double ns { t.elapsed() };
+
+        if (run == 0 || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
 Auto_ptr3<Resource> generateResource()
 {
 	Auto_ptr3<Resource> res{new Resource};
@@ -438,7 +1149,9 @@ DynamicArray<int> cloneArrayAndDouble(const DynamicArray<int> &arr)
 
 	return dbl;
 }
+#include <cstddef>  // For std::byte
 #include <iomanip>  // For std::setprecision
+#include <string>
 int main()
 {
 	// Auto_ptr3<Resource> mainres;
@@ -455,5 +1168,98 @@ int main()
 
 	std::cout <<std::setprecision(20)<<t.elapsed()<<" ns"<<std::endl;
 
+	// Appending one element at a time : geometric growth vs reserving up front
+	t.reset();
+	DynamicArray<int> grown;
+	for (int i = 0; i < 1000000; i++)
+		grown.push_back(i);
+	std::cout << "push_back x 1000000            : " << t.elapsed() << " ns (capacity " << grown.getCapacity() << ")\n";
+
+	t.reset();
+	DynamicArray<int> reserved;
+	reserved.reserve(1000000);
+	for (int i = 0; i < 1000000; i++)
+		reserved.push_back(i);
+	std::cout << "reserve + push_back x 1000000  : " << t.elapsed() << " ns (capacity " << reserved.getCapacity() << ")\n";
+
+	// Cost of one reallocation of 1000000 elements : realloc for trivially relocatable
+	// types (int, Texture), element-wise move + destroy for std::string
+	std::cout << "reallocate 1000000 int         : " << reallocationCost<int>(1000000) << " ns\n";
+	std::cout << "reallocate 1000000 std::string : " << reallocationCost<std::string>(1000000) << " ns\n";
+	std::cout << "reallocate 1000000 Texture     : " << reallocationCost<Texture>(1000000) << " ns\n";
+
+	// 10000 requests, each building 64 small scratch arrays : heap vs a bump arena per request
+	auto handleRequest = [](std::pmr::memory_resource * resource) {
+		long long sum {};
+		for (int scratch = 0; scratch < 64; ++scratch)
+		{
+			DynamicArray<int> values(resource);
+			values.reserve(16);
+			for (int i = 0; i < 16; ++i)
+				values.push_back(i * scratch);
+			sum += values[15];
+		}
+		return sum;
+	};
+
+	long long checksum {};
+	t.reset();
+	for (int request = 0; request < 10000; ++request)
+		checksum += handleRequest(nullptr);
+	std::cout << "10000 requests, C heap         : " << t.elapsed() << " ns\n";
+
+	t.reset();
+	for (int request = 0; request < 10000; ++request)
+	{
+		alignas(std::max_align_t) std::byte buffer[16 * 1024];
+		std::pmr::monotonic_buffer_resource arena { buffer, sizeof(buffer), std::pmr::null_memory_resource() };
+		checksum += handleRequest(&arena);
+	} // the whole arena is discarded at once, nothing is freed element by element
+	std::cout << "10000 requests, bump arena     : " << t.elapsed() << " ns\n";
+
+	std::pmr::unsynchronized_pool_resource pool {};
+	t.reset();
+	for (int request = 0; request < 10000; ++request)
+		checksum += handleRequest(&pool);
+	std::cout << "10000 requests, size pool      : " << t.elapsed() << " ns (checksum " << checksum << ")\n";
+
+	// move assignment keeps the pool : the heap buffer can't be handed to it, so the elements are moved over
+	DynamicArray<int> pooled(&pool);
+	DynamicArray<int> onHeap(3);
+	pooled = std::move(onHeap);
+	std::cout << "heap array moved into a pool array : " << pooled.getLength() << " elements, still in the pool : " << (pooled.getResource() == &pool) << '\n';
+
+	// one big array on 2 MB pages
+	HugePageResource hugePages {};
+	DynamicArray<int> big(&hugePages);
+	big.reserve(1 << 24);
+	t.reset();
+	for (int i = 0; i < big.getCapacity(); i++)
+		big.push_back(i);
+	std::cout << "push_back x " << big.getLength() << " on huge pages : " << t.elapsed() << " ns\n";
+
+	// 1000000 short arrays of 8 elements : one heap allocation each vs none
+	long long total {};
+	t.reset();
+	for (int n = 0; n < 1000000; ++n)
+	{
+		DynamicArray<int> shortArr;
+		shortArr.reserve(8);
+		for (int i = 0; i < 8; ++i)
+			shortArr.push_back(i + n);
+		total += shortArr[7];
+	}
+	std::cout << "1000000 short DynamicArray      : " << t.elapsed() << " ns\n";
+
+	t.reset();
+	for (int n = 0; n < 1000000; ++n)
+	{
+		SmallDynamicArray<int, 16> shortArr;
+		for (int i = 0; i < 8; ++i)
+			shortArr.push_back(i + n);
+		total += shortArr[7];
+	}
+	std::cout << "1000000 short SmallDynamicArray : " << t.elapsed() << " ns (checksum " << total << ")\n";
+
 	return 0;
 }
\ No newline at end of file
@@ -234,9 +234,256 @@
 
         - If you do, the std::unique_ptr will try to delete an already deleted resource, again leading to undefined behavior. Note that std::make_unique() prevents both of the above cases from happening inadvertently.
 
+    10. Custom deleters and an object pool :
+
+        - std::unique_ptr<T, Deleter> calls Deleter{}(ptr) instead of delete ptr. When the deleter is an empty class, the std::unique_ptr is still the size of one pointer.
+
+        - When a program creates and destroys lots of short lived objects of the same type, new and delete (a trip through the general purpose allocator each time) can become a visible part of the profile. An object pool keeps the memory of destroyed objects and hands it out again :
+
+            pool_ptr<Resource> res { make_pooled<Resource>() };   // std::unique_ptr<Resource, PoolDeleter<Resource>>
+            ...
+            // res goes out of scope : ~Resource() runs, and the memory goes back to the pool, not to the heap
+
+        - ObjectPool<T> has one instance per type (ObjectPool<T>::instance()). Free slots are kept in two places :
+
+            = a thread local free list : create() and destroy() almost always just pop / push it, no locks and no atomics.
+            = a global lock free stack of batches of slots : when a thread's list grows too long (it destroys more than it creates) it pushes a batch there, and a thread whose list is empty pops a batch from there before allocating a new block.
+
+        - The global stack is a Treiber stack : push and pop are a compare_exchange on the head. The head also holds a counter in its upper 16 bits (pointers only use 48 bits on x86-64 and AArch64), which protects pop against the ABA problem : between reading the head and the compare_exchange, another thread can pop that batch and push it back, and the counter makes the compare_exchange fail in that case.
+
+        - Memory is never given back to the heap : the pool (and its blocks) lives until the program ends, so a thread can safely return its list to the pool when it exits.
+
+        - A std::shared_ptr can be made from a pool_ptr (make_pooled_shared), and the object goes back to the pool when the last owner is gone. The control block is still allocated by std::shared_ptr though.
+
 */
 #include <memory> // for std::unique_ptr
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Timer
+{
+	using Clock = std::chrono::high_resolution_clock;
+	using Nanosecond = std::chrono::duration<double, std::nano>;
+
+	std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+	void reset()
+	{
+		_begin = Clock::now();
+	}
+
+	double elapsed() const
+	{
+		return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+	}
+};
+
+template <typename T>
+class ObjectPool
+{
+	static_assert(sizeof(void*) == 8, "the ABA counter lives in the upper 16 bits of a 64 bit pointer");
+
+	struct Slot
+	{
+		alignas(T) unsigned char m_storage[sizeof(T)];
+		std::atomic<Slot*> m_next {};       // next free slot in the same batch
+		std::atomic<Slot*> m_nextBatch {};  // next batch on the global stack, only used on a batch's first slot
+	};
+
+	static constexpr int batchSize { 64 };
+	static constexpr std::uint64_t pointerMask { (std::uint64_t{ 1 } << 48) - 1 };
+
+	// the global stack of batches : pointer in the low 48 bits, ABA counter in the high 16
+	std::atomic<std::uint64_t> m_batches {};
+
+	// every block ever allocated (blocks are rare, a mutex is fine here)
+	std::vector<std::unique_ptr<Slot[]>> m_blocks {};
+	mutable std::mutex m_blocksMutex {};
+
+	struct LocalList
+	{
+		Slot* m_head { nullptr };
+		int m_count { 0 };
+
+		~LocalList()
+		{
+			// the thread is going away, hand its slots to the other threads
+			while (m_head)
+				ObjectPool::instance().pushBatch(takeBatch());
+		}
+
+		void push(Slot* slot)
+		{
+			slot->m_next.store(m_head, std::memory_order_relaxed);
+			m_head = slot;
+			++m_count;
+		}
+
+		Slot* pop()
+		{
+			Slot* slot { m_head };
+			m_head = slot->m_next.load(std::memory_order_relaxed);
+			--m_count;
+			return slot;
+		}
+
+		// unlink up to batchSize slots from the front
+		Slot* takeBatch()
+		{
+			Slot* first { m_head };
+			Slot* last { m_head };
+			int taken { 1 };
+			for (; taken < batchSize && last->m_next.load(std::memory_order_relaxed); ++taken)
+				last = last->m_next.load(std::memory_order_relaxed);
+
+			m_head = last->m_next.load(std::memory_order_relaxed);
+			last->m_next.store(nullptr, std::memory_order_relaxed);
+			m_count -= taken;
+			return first;
+		}
+	};
+
+	static LocalList& localList()
+	{
+		thread_local LocalList list {};
+		return list;
+	}
+
+	static Slot* toSlot(std::uint64_t head) { return reinterpret_cast<Slot*>(head & pointerMask); }
+
+	void pushBatch(Slot* batch)
+	{
+		std::uint64_t head { m_batches.load(std::memory_order_relaxed) };
+		std::uint64_t newHead {};
+		do
+		{
+			batch->m_nextBatch.store(toSlot(head), std::memory_order_relaxed);
+			newHead = reinterpret_cast<std::uint64_t>(batch) | ((head & ~pointerMask) + (pointerMask + 1));
+		} while (!m_batches.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	Slot* popBatch()
+	{
+		std::uint64_t head { m_batches.load(std::memory_order_acquire) };
+		for (;;)
+		{
+			Slot* batch { toSlot(head) };
+			if (!batch)
+				return nullptr;
+
+			// batch may already have been popped by another thread, its memory is still ours
+			// (never freed), and the counter makes the exchange below fail in that case
+			std::uint64_t newHead { reinterpret_cast<std::uint64_t>(batch->m_nextBatch.load(std::memory_order_relaxed))
+									| ((head & ~pointerMask) + (pointerMask + 1)) };
+			if (m_batches.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+				return batch;
+		}
+	}
+
+	void refill(LocalList& list)
+	{
+		Slot* batch { popBatch() };
+		if (!batch)
+		{
+			auto block { std::make_unique<Slot[]>(batchSize) };
+			batch = block.get();
+			for (int i = 0; i < batchSize - 1; ++i)
+				batch[i].m_next.store(&batch[i + 1], std::memory_order_relaxed);
+
+			std::lock_guard lock { m_blocksMutex };
+			m_blocks.push_back(std::move(block));
+		}
+
+		for (Slot* slot { batch }; slot; )
+		{
+			Slot* next { slot->m_next.load(std::memory_order_relaxed) };
+			list.push(slot);
+			slot = next;
+		}
+	}
+
+	ObjectPool() = default;
+
+public:
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	static ObjectPool& instance()
+	{
+		static ObjectPool& pool { *new ObjectPool{} }; // never destroyed, threads may still return slots at exit
+		return pool;
+	}
+
+	template <typename... Args>
+	T* create(Args&&... args)
+	{
+		LocalList& list { localList() };
+		if (!list.m_head)
+			refill(list);
+
+		Slot* slot { list.pop() };
+		try
+		{
+			return ::new (static_cast<void*>(slot->m_storage)) T(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			list.push(slot);
+			throw;
+		}
+	}
+
+	void destroy(T* ptr) noexcept
+	{
+		ptr->~T();
+
+		// m_storage is the first member, so the object's address is the slot's address
+		LocalList& list { localList() };
+		list.push(reinterpret_cast<Slot*>(ptr));
+
+		if (list.m_count >= 2 * batchSize)
+			pushBatch(list.takeBatch());
+	}
+
+	long long getBlockCount() const
+	{
+		std::lock_guard lock { m_blocksMutex };
+		return static_cast<long long>(m_blocks.size());
+	}
+};
+
+template <typename T>
+struct PoolDeleter
+{
+	void operator()(T* ptr) const noexcept
+	{
+		ObjectPool<T>::instance().destroy(ptr);
+	}
+};
+
+template <typename T>
+using pool_ptr = std::unique_ptr<T, PoolDeleter<T>>;
+
+template <typename T, typename... Args>
+pool_ptr<T> make_pooled(Args&&... args)
+{
+	return pool_ptr<T>{ ObjectPool<T>::instance().create(std::forward<Args>(args)...) };
+}
+
+template <typename T, typename... Args>
+std::shared_ptr<T> make_pooled_shared(Args&&... args)
+{
+	return std::shared_ptr<T>{ make_pooled<T>(std::forward<Args>(args)...) };
+}
 
 class Resource
 {
@@ -266,6 +513,45 @@ int main()
 
 	useResource(ptr.get()); // note: get() used here to get a pointer to the Resource
 
+	{
+		pool_ptr<Resource> pooled { make_pooled<Resource>() };
+		std::shared_ptr<Resource> shared { make_pooled_shared<Resource>() };
+		useResource(pooled.get());
+		std::cout << "sizeof pool_ptr<Resource> : " << sizeof(pooled) << '\n';
+	} // both Resources are destroyed here, and their memory goes back to the pool
+
+	// short lived objects : 4 threads, each creating and destroying 16 at a time
+	struct Message
+	{
+		int m_data[16] {};
+	};
+
+	constexpr int rounds { 200000 };
+	auto churn = [](auto create) {
+		std::vector<std::thread> threads;
+		Timer t;
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([create] {
+				for (int round = 0; round < rounds; ++round)
+				{
+					decltype(create()) messages[16];
+					for (auto& message : messages)
+						message = create();
+					messages[round % 16]->m_data[0] = round;
+				}
+			});
+		}
+		for (auto& thread : threads)
+			thread.join();
+		return t.elapsed() / (4.0 * rounds * 16);
+	};
+
+	std::cout << "ns per create + destroy :\n";
+	std::cout << "  std::make_unique : " << churn([] { return std::make_unique<Message>(); }) << '\n';
+	std::cout << "  make_pooled      : " << churn([] { return make_pooled<Message>(); }) << '\n';
+	std::cout << "  pool blocks      : " << ObjectPool<Message>::instance().getBlockCount() << '\n';
+
 	std::cout << "Ending program\n";
 
 	return 0;
@@ -113,10 +113,210 @@
 
     8. Conclusion : std::shared_ptr is designed for the case where you need multiple smart pointers co-managing the same resource. The resource will be deallocated when the last std::shared_ptr managing the resource is destroyed.
 
+    9. Intrusive reference counting (intrusive_ptr) :
+
+        - std::shared_ptr built from a raw new Resource costs two allocations (the Resource, then the control block), every handle is two pointers wide, and every copy and destruction is an atomic increment / decrement of the count in the control block.
+
+        - An intrusive pointer moves the count into the object itself. The class opts in by deriving from RefCounted, and the handle is a single pointer :
+
+            class Texture : public RefCounted<>
+            {
+                ...
+            };
+
+            intrusive_ptr<Texture> tex { make_intrusive<Texture>() };  // one allocation : just the Texture
+            intrusive_ptr<Texture> copy { tex };                       // count is now 2
+
+        - Since the count travels with the object, building a second intrusive_ptr from the same raw pointer is fine (unlike the std::shared_ptr example in note 2) : both handles find the same count.
+
+        - Counting policy :
+
+            RefCounted<AtomicRefCount>   : (default) std::atomic count, handles can be shared between threads
+            RefCounted<PlainRefCount>    : a plain int, for objects that never leave one thread; a copy is then a normal increment
+
+        - Fast paths that skip the count entirely :
+
+            = moving a handle (move constructor / move assignment) only steals the pointer, the count doesn't change.
+            = detach() gives up ownership without a decrement, and intrusive_ptr{ptr, adopt} takes ownership without an increment, to hand an object through code that deals in raw pointers.
+            = a function that only looks at the object should take const intrusive_ptr<T>& (or T&), not a copy.
+
+        - The costs : the class has to be written for it (can't be used with int or a library type), there is no weak pointer, and the object is deleted through intrusive_ptr<T>, so T must be the most derived type or have a virtual destructor.
+
 
 */
 
+#include <atomic>
+#include <chrono>
 #include <memory> // for std::shared_ptr
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Timer
+{
+	using Clock = std::chrono::high_resolution_clock;
+	using Nanosecond = std::chrono::duration<double, std::nano>;
+
+	std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+	void reset()
+	{
+		_begin = Clock::now();
+	}
+
+	double elapsed() const
+	{
+		return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+	}
+};
+
+struct AtomicRefCount
+{
+	std::atomic<int> m_count { 0 };
+
+	void increment() { m_count.fetch_add(1, std::memory_order_relaxed); }
+
+	// acq_rel : the thread that deletes the object must see every other owner's writes to it
+	bool decrement() { return m_count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+	int get() const { return m_count.load(std::memory_order_relaxed); }
+};
+
+struct PlainRefCount
+{
+	int m_count { 0 };
+
+	void increment() { ++m_count; }
+	bool decrement() { return --m_count == 0; }
+	int get() const { return m_count; }
+};
+
+template <typename Count = AtomicRefCount>
+class RefCounted
+{
+	mutable Count m_refCount {};
+
+	template <typename T>
+	friend class intrusive_ptr;
+
+protected:
+	RefCounted() = default;
+
+	// a copy of the object is a new object, with no owners yet
+	RefCounted(const RefCounted&) {}
+	RefCounted& operator=(const RefCounted&) { return *this; }
+
+public:
+	int getRefCount() const { return m_refCount.get(); }
+};
+
+struct adopt_t { explicit adopt_t() = default; };
+inline constexpr adopt_t adopt {};
+
+template <typename T>
+class intrusive_ptr
+{
+	T* m_ptr { nullptr };
+
+	void retain() const
+	{
+		if (m_ptr)
+			m_ptr->m_refCount.increment();
+	}
+
+	void drop()
+	{
+		if (m_ptr && m_ptr->m_refCount.decrement())
+			delete m_ptr;
+	}
+
+public:
+	intrusive_ptr() = default;
+
+	explicit intrusive_ptr(T* ptr) : m_ptr { ptr } { retain(); }
+
+	// take over a reference the caller already owns (see detach())
+	intrusive_ptr(T* ptr, adopt_t) : m_ptr { ptr } {}
+
+	~intrusive_ptr() { drop(); }
+
+	intrusive_ptr(const intrusive_ptr& copy) : m_ptr { copy.m_ptr } { retain(); }
+
+	intrusive_ptr(intrusive_ptr&& copy) noexcept : m_ptr { std::exchange(copy.m_ptr, nullptr) } {}
+
+	intrusive_ptr& operator=(const intrusive_ptr& copy)
+	{
+		copy.retain(); // before drop(), in case both point at the same object
+		drop();
+		m_ptr = copy.m_ptr;
+
+		return *this;
+	}
+
+	intrusive_ptr& operator=(intrusive_ptr&& copy) noexcept
+	{
+		if (this == &copy)
+			return *this;
+
+		drop();
+		m_ptr = std::exchange(copy.m_ptr, nullptr);
+
+		return *this;
+	}
+
+	// give up ownership without touching the count
+	T* detach() { return std::exchange(m_ptr, nullptr); }
+
+	void reset() { drop(); m_ptr = nullptr; }
+
+	T* get() const { return m_ptr; }
+	T& operator*() const { return *m_ptr; }
+	T* operator->() const { return m_ptr; }
+	explicit operator bool() const { return m_ptr != nullptr; }
+};
+
+template <typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args&&... args)
+{
+	return intrusive_ptr<T>{ new T(std::forward<Args>(args)...) };
+}
+
+// The Resource below, with its count inside
+template <typename Count = AtomicRefCount>
+class CountedResource : public RefCounted<Count>
+{
+public:
+	CountedResource() { std::cout << "CountedResource acquired\n"; }
+	~CountedResource() { std::cout << "CountedResource destroyed\n"; }
+};
+
+// A quiet payload for timing handle copies
+template <typename Count>
+struct Payload : RefCounted<Count>
+{
+	int m_value {};
+};
+
+// copies handles into a vector, then destroys them : one increment and one decrement each
+template <typename Handle>
+double copyHandles(const Handle& handle, int copies)
+{
+	std::vector<Handle> handles;
+	handles.reserve(copies);
+
+	// fault the vector's pages in first, so only the handles are timed
+	for (int i = 0; i < copies; ++i)
+		handles.push_back(handle);
+	handles.clear();
+
+	Timer t;
+	for (int i = 0; i < copies; ++i)
+		handles.push_back(handle);
+	handles.clear();
+
+	return t.elapsed() / copies;
+}
 
 class Resource
 {
@@ -138,5 +338,32 @@ int main()
 
 	std::cout << "Killing another shared pointer\n";
 
+	{
+		// one allocation, the count is inside the CountedResource
+		auto res1 { make_intrusive<CountedResource<>>() };
+		{
+			intrusive_ptr<CountedResource<>> res2 { res1.get() }; // fine : the raw pointer leads to the same count
+			std::cout << "Owners : " << res1->getRefCount() << '\n';
+		}
+
+		// move only hand off : no count traffic
+		CountedResource<>* raw { res1.detach() };
+		intrusive_ptr<CountedResource<>> res3 { raw, adopt };
+		std::cout << "Owners after detach / adopt : " << res3->getRefCount() << '\n';
+	}
+
+	std::cout << "sizeof handle : std::shared_ptr " << sizeof(std::shared_ptr<Resource>)
+			  << ", intrusive_ptr " << sizeof(intrusive_ptr<CountedResource<>>) << '\n';
+
+	// libstdc++'s std::shared_ptr uses plain increments until the program starts its first thread,
+	// start one so the timings are the ones a multi threaded program gets
+	std::thread{ [] {} }.join();
+
+	constexpr int copies { 10000000 };
+	std::cout << "ns per copy + destroy :\n";
+	std::cout << "  std::shared_ptr           : " << copyHandles(std::make_shared<int>(), copies) << '\n';
+	std::cout << "  intrusive_ptr (atomic)    : " << copyHandles(make_intrusive<Payload<AtomicRefCount>>(), copies) << '\n';
+	std::cout << "  intrusive_ptr (plain int) : " << copyHandles(make_intrusive<Payload<PlainRefCount>>(), copies) << '\n';
+
 	return 0;
 } // ptr1 goes out of scope here, and the allocated Resource is destroyed
\ No newline at end of file
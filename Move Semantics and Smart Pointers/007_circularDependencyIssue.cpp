@@ -216,9 +216,740 @@
 
     7. std::shared_ptr can be used when you need multiple smart pointers that can co-own a resource. The resource will be deallocated when the last std::shared_ptr goes out of scope. std::weak_ptr can be used when you want a smart pointer that can see and use a shared resource, but does not participate in the ownership of that resource.
 
+    8. A cache built on std::weak_ptr (WeakCache) :
+
+        - Expensive objects (a decoded image, a parsed document) are often needed by several requests at the same time. A cache of std::shared_ptr shares them, but keeps every one of them alive forever. A cache of std::weak_ptr shares them without owning them : as long as some client holds the object, find() returns it, and once the last client lets go the object is destroyed and the entry simply reads as expired (getWeakPtr above).
+
+        - Objects that are used often but not held all the time would then be destroyed and decoded again and again, so WeakCache also has an optional strong tier : up to strongCapacity recently inserted objects are held by a std::shared_ptr inside the cache as well. The tier is split between the shards (strongCapacity / shards slots each, the remainder going one by one to the first shards), so the bound is exact in total, but each shard evicts among its own slots : the tier holds roughly, not exactly, the last strongCapacity objects. When a shard's part of the tier is full, inserting evicts the least recently used one from the tier (it stays in the cache as a weak entry, and lives on if a client holds it).
+
+        - Concurrency :
+
+            = the cache is split into shards by the hash of the key, each with its own lock, so threads working on different keys rarely wait for each other (lock striping).
+            = find() only takes its shard's lock in shared mode (std::shared_mutex), so any number of lookups run in parallel. Only inserting takes the lock exclusively.
+            = with a shared lock, a lookup can't reorder an LRU list, so the strong tier uses the CLOCK approximation of LRU : a hit only sets an atomic "referenced" flag, and eviction skips (and clears) flagged entries.
+            = getOrCreate() builds a missing object without holding any lock. If two threads miss the same key at the same time both build it, and the second one to insert gets the first one's object back.
+
+        - Expired entries are removed while inserting, whenever the shard has doubled in size since the last sweep.
+
+    9. Collecting cycles instead of avoiding them (gc_ptr) :
+
+        - std::weak_ptr only helps if every back pointer is known and written as a std::weak_ptr. In a graph that users build (people and their partners, friends, followers) there is no "back" direction, and a single missed std::weak_ptr leaks a whole group of objects for as long as the program runs.
+
+        - gc_ptr<T> is a reference counted pointer (like std::shared_ptr) with a cycle collector on top, using trial deletion (Bacon and Rajan, "Concurrent Cycle Collection in Reference Counted Systems", the synchronous version) :
+
+            = A count that drops to 0 frees the object right away, as usual.
+            = A count that drops to something else might have left a cycle with no outside owner, so the object is remembered as a candidate root (it is colored "purple").
+            = The collector then, for the candidates : subtracts the counts due to pointers inside the subgraph reachable from them (mark gray). Objects whose count is still above 0 are owned from outside, so they and everything they reach are restored (scan black). The rest (white) are only owned by each other : garbage.
+
+        - Classes opt in by deriving from GcObject and listing their gc_ptr members in trace() :
+
+            class Person : public GcObject
+            {
+                std::string m_name;
+                gc_ptr<Person> m_partner;   // no std::weak_ptr needed
+
+                void trace(GcVisitor& visitor) override { visitor(m_partner); }
+                ...
+            };
+
+            auto lucy { make_gc<Person>("Lucy") };
+
+        - Collecting in small steps : GcHeap::collectStep(budget) takes the candidates in batches and stops starting new batches once budget has passed, so a program can call it once per frame / per request without a long pause. A candidate reached from the current batch is moved into it (otherwise its count would be left half subtracted), which keeps every batch exact. The budget can still be overrun by one batch whose objects are all connected to each other : trial deletion has to see a whole connected group at once.
+
+        - Each step reports how many objects and bytes (sizeof of the objects made with make_gc) were reclaimed.
+
+        - Limits : a single heap for the whole program, not thread safe; no weak pointers.
+
 */
 
 #include <memory>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class WeakCache
+{
+	struct Entry
+	{
+		std::weak_ptr<Value> m_weak {};
+		std::atomic<bool> m_referenced {};  // CLOCK bit, set by lookups under the shared lock
+		int m_strongSlot { -1 };            // index in m_strong, -1 if only held weakly
+	};
+
+	struct StrongSlot
+	{
+		std::shared_ptr<Value> m_value {};
+		Entry* m_entry { nullptr };
+	};
+
+	struct alignas(64) Shard
+	{
+		mutable std::shared_mutex m_mutex {};
+		std::unordered_map<Key, Entry, Hash> m_entries {};
+		std::vector<StrongSlot> m_strong {};
+		int m_strongCapacity {};            // this shard's part of the strong tier
+		int m_hand {};
+		std::size_t m_sweepAt { 64 };
+		std::atomic<long long> m_hits {};
+		std::atomic<long long> m_misses {};
+	};
+
+	std::vector<Shard> m_shards;
+	Hash m_hash {};
+
+	Shard& shardFor(const Key& key)
+	{
+		return m_shards[m_hash(key) & (m_shards.size() - 1)];
+	}
+
+	// hold value strongly, evicting with the CLOCK hand if the tier is full. The value it replaces goes to released,
+	// so the caller can destroy it after unlocking (its destructor may use the cache)
+	void holdStrongly(Shard& shard, Entry& entry, const std::shared_ptr<Value>& value, std::shared_ptr<Value>& released)
+	{
+		if (shard.m_strongCapacity == 0)
+			return;
+
+		if (entry.m_strongSlot >= 0)
+		{
+			released = std::exchange(shard.m_strong[entry.m_strongSlot].m_value, value);
+			return;
+		}
+
+		int slot {};
+		if (static_cast<int>(shard.m_strong.size()) < shard.m_strongCapacity)
+		{
+			slot = static_cast<int>(shard.m_strong.size());
+			shard.m_strong.emplace_back();
+		}
+		else
+		{
+			for (;; shard.m_hand = (shard.m_hand + 1) % shard.m_strongCapacity)
+			{
+				Entry& victim { *shard.m_strong[shard.m_hand].m_entry };
+				if (!victim.m_referenced.exchange(false, std::memory_order_relaxed))
+					break;
+			}
+			slot = shard.m_hand;
+			shard.m_hand = (shard.m_hand + 1) % shard.m_strongCapacity;
+			shard.m_strong[slot].m_entry->m_strongSlot = -1;
+			released = std::move(shard.m_strong[slot].m_value);
+		}
+
+		shard.m_strong[slot] = StrongSlot{ value, &entry };
+		entry.m_strongSlot = slot;
+	}
+
+	void sweep(Shard& shard)
+	{
+		for (auto it { shard.m_entries.begin() }; it != shard.m_entries.end(); )
+		{
+			if (it->second.m_strongSlot < 0 && it->second.m_weak.expired())
+				it = shard.m_entries.erase(it);
+			else
+				++it;
+		}
+		shard.m_sweepAt = std::max<std::size_t>(64, 2 * shard.m_entries.size());
+	}
+
+public:
+	// shardCount is rounded up to a power of 2. strongCapacity is split between the shards : each gets
+	// strongCapacity / shards slots, and the first strongCapacity % shards get one more, so the total is exactly strongCapacity
+	explicit WeakCache(int strongCapacity = 0, int shardCount = 16)
+	: m_shards(std::bit_ceil(static_cast<std::size_t>(std::max(1, shardCount))))
+	{
+		int shards { static_cast<int>(m_shards.size()) };
+		for (int i = 0; i < shards; ++i)
+			m_shards[i].m_strongCapacity = strongCapacity / shards + (i < strongCapacity % shards ? 1 : 0);
+	}
+
+	WeakCache(const WeakCache&) = delete;
+	WeakCache& operator=(const WeakCache&) = delete;
+
+	// nullptr if the key was never inserted, or if its object has been destroyed
+	std::shared_ptr<Value> find(const Key& key)
+	{
+		Shard& shard { shardFor(key) };
+		std::shared_lock lock { shard.m_mutex };
+
+		auto it { shard.m_entries.find(key) };
+		std::shared_ptr<Value> value { it != shard.m_entries.end() ? it->second.m_weak.lock() : nullptr };
+		if (value)
+		{
+			it->second.m_referenced.store(true, std::memory_order_relaxed);
+			shard.m_hits.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			shard.m_misses.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		return value;
+	}
+
+	// Insert value under key, unless a live object is already there : the one in the cache is returned
+	std::shared_ptr<Value> insert(const Key& key, std::shared_ptr<Value> value)
+	{
+		Shard& shard { shardFor(key) };
+		std::shared_ptr<Value> released {}; // destroyed after the lock is released
+		std::unique_lock lock { shard.m_mutex };
+
+		Entry& entry { shard.m_entries[key] };
+		if (auto existing { entry.m_weak.lock() })
+			return existing;
+
+		entry.m_weak = value;
+		entry.m_referenced.store(false, std::memory_order_relaxed);
+		holdStrongly(shard, entry, value, released);
+
+		if (shard.m_entries.size() >= shard.m_sweepAt)
+			sweep(shard);
+
+		return value;
+	}
+
+	// The cached object, or make() one (outside of any lock) and insert it
+	template <typename Factory>
+	std::shared_ptr<Value> getOrCreate(const Key& key, Factory make)
+	{
+		if (auto value { find(key) })
+			return value;
+
+		return insert(key, make());
+	}
+
+	void erase(const Key& key)
+	{
+		Shard& shard { shardFor(key) };
+		std::shared_ptr<Value> released {}; // destroyed after the lock is released
+		std::unique_lock lock { shard.m_mutex };
+
+		auto it { shard.m_entries.find(key) };
+		if (it == shard.m_entries.end())
+			return;
+
+		if (int slot { it->second.m_strongSlot }; slot >= 0)
+		{
+			// move the last strong slot into the hole
+			released = std::move(shard.m_strong[slot].m_value);
+			shard.m_strong[slot] = std::move(shard.m_strong.back());
+			shard.m_strong.pop_back();
+			if (slot < static_cast<int>(shard.m_strong.size()))
+				shard.m_strong[slot].m_entry->m_strongSlot = slot;
+			if (shard.m_hand >= static_cast<int>(shard.m_strong.size()))
+				shard.m_hand = 0;
+		}
+		shard.m_entries.erase(it);
+	}
+
+	long long getHits() const
+	{
+		long long hits {};
+		for (const Shard& shard : m_shards)
+			hits += shard.m_hits.load(std::memory_order_relaxed);
+		return hits;
+	}
+
+	long long getMisses() const
+	{
+		long long misses {};
+		for (const Shard& shard : m_shards)
+			misses += shard.m_misses.load(std::memory_order_relaxed);
+		return misses;
+	}
+
+	// Live objects, whether held by the cache or only by clients
+	int getLiveCount() const
+	{
+		int live {};
+		for (const Shard& shard : m_shards)
+		{
+			std::shared_lock lock { shard.m_mutex };
+			for (const auto& [key, entry] : shard.m_entries)
+				live += !entry.m_weak.expired();
+		}
+		return live;
+	}
+};
+
+class GcHeap;
+class GcObject;
+
+class GcPtrBase
+{
+protected:
+	GcObject* m_object { nullptr };
+
+	GcPtrBase() = default;
+
+	friend class GcHeap;
+};
+
+class GcVisitor
+{
+public:
+	virtual void operator()(GcPtrBase& ptr) = 0;
+
+protected:
+	~GcVisitor() = default;
+};
+
+class GcObject
+{
+	enum class Color : unsigned char
+	{
+		black,  // in use
+		gray,   // being trial deleted
+		white,  // garbage
+		purple, // candidate root of a garbage cycle
+	};
+
+	int m_refCount {};
+	int m_rootIndex { -1 };  // position in GcHeap::m_roots, -1 if not a candidate
+	Color m_color { Color::black };
+	std::size_t m_size {};
+
+	friend class GcHeap;
+
+protected:
+	GcObject() = default;
+
+	// a copy is a new object, with no owners yet
+	GcObject(const GcObject&) {}
+	GcObject& operator=(const GcObject&) { return *this; }
+
+public:
+	virtual ~GcObject() = default;
+
+	// call visitor(ptr) for every gc_ptr this object holds
+	virtual void trace(GcVisitor& visitor) = 0;
+};
+
+struct GcStats
+{
+	long long objectsReclaimed {};
+	long long bytesReclaimed {};
+	long long rootsScanned {};
+};
+
+class GcHeap
+{
+	using Color = GcObject::Color;
+
+	static constexpr std::size_t batchSize { 256 };
+
+	std::vector<GcObject*> m_roots {};
+	GcStats m_total {};
+
+	GcHeap() = default;
+
+	template <typename F>
+	static void forEachChild(GcObject* object, F f)
+	{
+		struct Visitor : GcVisitor
+		{
+			F& m_f;
+			explicit Visitor(F& f) : m_f{ f } {}
+			void operator()(GcPtrBase& ptr) override
+			{
+				if (ptr.m_object)
+					m_f(ptr);
+			}
+		};
+
+		Visitor visitor { f };
+		object->trace(visitor);
+	}
+
+	void addRoot(GcObject* object)
+	{
+		object->m_rootIndex = static_cast<int>(m_roots.size());
+		m_roots.push_back(object);
+	}
+
+	void removeRoot(GcObject* object)
+	{
+		GcObject* last { m_roots.back() };
+		m_roots[object->m_rootIndex] = last;
+		last->m_rootIndex = object->m_rootIndex;
+		m_roots.pop_back();
+		object->m_rootIndex = -1;
+	}
+
+	void free(GcObject* object)
+	{
+		++m_total.objectsReclaimed;
+		m_total.bytesReclaimed += static_cast<long long>(object->m_size);
+		delete object;
+	}
+
+	// The count dropped to 0 : drop the children, free the object unless it is still in m_roots
+	void release(GcObject* object)
+	{
+		forEachChild(object, [this](GcPtrBase& child) { decrement(std::exchange(child.m_object, nullptr)); });
+		object->m_color = Color::black;
+		if (object->m_rootIndex < 0)
+			free(object);
+	}
+
+	void possibleRoot(GcObject* object)
+	{
+		if (object->m_color != Color::purple)
+		{
+			object->m_color = Color::purple;
+			if (object->m_rootIndex < 0)
+				addRoot(object);
+		}
+	}
+
+	// Subtract the internal pointers. Candidates we reach join the batch.
+	void markGray(GcObject* object, std::vector<GcObject*>& stack)
+	{
+		if (object->m_color == Color::gray)
+			return;
+
+		object->m_color = Color::gray;
+		stack.push_back(object);
+		while (!stack.empty())
+		{
+			GcObject* gray { stack.back() };
+			stack.pop_back();
+			forEachChild(gray, [this, &stack](GcPtrBase& ptr) {
+				GcObject* child { ptr.m_object };
+				--child->m_refCount;
+				if (child->m_color != Color::gray)
+				{
+					if (child->m_rootIndex >= 0)
+						removeRoot(child);
+					child->m_color = Color::gray;
+					stack.push_back(child);
+				}
+			});
+		}
+	}
+
+	// Owned from outside : restore the counts of everything reachable
+	void scanBlack(GcObject* object, std::vector<GcObject*>& stack)
+	{
+		object->m_color = Color::black;
+		stack.push_back(object);
+		while (!stack.empty())
+		{
+			GcObject* black { stack.back() };
+			stack.pop_back();
+			forEachChild(black, [&stack](GcPtrBase& ptr) {
+				GcObject* child { ptr.m_object };
+				++child->m_refCount;
+				if (child->m_color != Color::black)
+				{
+					child->m_color = Color::black;
+					stack.push_back(child);
+				}
+			});
+		}
+	}
+
+	void scan(GcObject* object, std::vector<GcObject*>& stack, std::vector<GcObject*>& blackStack)
+	{
+		stack.push_back(object);
+		while (!stack.empty())
+		{
+			GcObject* next { stack.back() };
+			stack.pop_back();
+			if (next->m_color != Color::gray)
+				continue;
+
+			if (next->m_refCount > 0)
+			{
+				scanBlack(next, blackStack);
+			}
+			else
+			{
+				next->m_color = Color::white;
+				forEachChild(next, [&stack](GcPtrBase& ptr) { stack.push_back(ptr.m_object); });
+			}
+		}
+	}
+
+	void collectWhite(GcObject* object, std::vector<GcObject*>& stack, std::vector<GcObject*>& garbage)
+	{
+		if (object->m_color != Color::white)
+			return;
+
+		object->m_color = Color::black;
+		stack.push_back(object);
+		while (!stack.empty())
+		{
+			GcObject* white { stack.back() };
+			stack.pop_back();
+			garbage.push_back(white);
+			forEachChild(white, [&stack](GcPtrBase& ptr) {
+				GcObject* child { ptr.m_object };
+				if (child->m_color == Color::white)
+				{
+					child->m_color = Color::black;
+					stack.push_back(child);
+				}
+			});
+		}
+	}
+
+	void collectBatch(std::vector<GcObject*>& batch)
+	{
+		m_total.rootsScanned += static_cast<long long>(batch.size());
+
+		std::vector<GcObject*> stack {};
+		std::vector<GcObject*> blackStack {};
+
+		// mark roots : drop the candidates that are in use again, free the ones released meanwhile
+		std::vector<GcObject*> marked {};
+		for (GcObject* root : batch)
+		{
+			if (root->m_color == Color::purple && root->m_refCount > 0)
+			{
+				markGray(root, stack);
+				marked.push_back(root);
+			}
+			else if (root->m_color == Color::black && root->m_refCount == 0)
+			{
+				free(root);
+			}
+		}
+
+		for (GcObject* root : marked)
+			scan(root, stack, blackStack);
+
+		std::vector<GcObject*> garbage {};
+		for (GcObject* root : marked)
+			collectWhite(root, stack, garbage);
+
+		// the counts inside the garbage are already gone (markGray), so cut the pointers without decrementing
+		for (GcObject* object : garbage)
+			forEachChild(object, [](GcPtrBase& ptr) { ptr.m_object = nullptr; });
+		for (GcObject* object : garbage)
+			free(object);
+	}
+
+	GcStats since(const GcStats& before) const
+	{
+		return GcStats{ m_total.objectsReclaimed - before.objectsReclaimed,
+						m_total.bytesReclaimed - before.bytesReclaimed,
+						m_total.rootsScanned - before.rootsScanned };
+	}
+
+	std::vector<GcObject*> takeBatch(std::size_t count)
+	{
+		count = std::min(count, m_roots.size());
+		std::vector<GcObject*> batch(m_roots.end() - static_cast<std::ptrdiff_t>(count), m_roots.end());
+		m_roots.resize(m_roots.size() - count);
+		for (GcObject* root : batch)
+			root->m_rootIndex = -1;
+
+		return batch;
+	}
+
+public:
+	GcHeap(const GcHeap&) = delete;
+	GcHeap& operator=(const GcHeap&) = delete;
+
+	static GcHeap& instance()
+	{
+		static GcHeap& heap { *new GcHeap{} }; // never destroyed, global gc_ptrs may outlive any static
+		return heap;
+	}
+
+	void track(GcObject* object, std::size_t size)
+	{
+		object->m_size = size;
+	}
+
+	void increment(GcObject* object)
+	{
+		++object->m_refCount;
+		object->m_color = Color::black;
+	}
+
+	void decrement(GcObject* object)
+	{
+		if (--object->m_refCount == 0)
+			release(object);
+		else
+			possibleRoot(object);
+	}
+
+	// Work through the candidates, starting batches until budget has passed
+	GcStats collectStep(std::chrono::microseconds budget = std::chrono::microseconds{ 1000 })
+	{
+		GcStats before { m_total };
+		auto start { std::chrono::steady_clock::now() };
+
+		while (!m_roots.empty())
+		{
+			std::vector<GcObject*> batch { takeBatch(batchSize) };
+			collectBatch(batch);
+			if (std::chrono::steady_clock::now() - start >= budget)
+				break;
+		}
+
+		return since(before);
+	}
+
+	// Everything at once
+	GcStats collect()
+	{
+		GcStats before { m_total };
+		while (!m_roots.empty())
+		{
+			std::vector<GcObject*> batch { takeBatch(m_roots.size()) };
+			collectBatch(batch);
+		}
+
+		return since(before);
+	}
+
+	std::size_t getCandidateCount() const { return m_roots.size(); }
+	const GcStats& getTotalStats() const { return m_total; }
+};
+
+template <typename T>
+class gc_ptr : public GcPtrBase
+{
+	// only make_gc creates the first owner
+	explicit gc_ptr(T* object)
+	{
+		m_object = object;
+		GcHeap::instance().increment(m_object);
+	}
+
+	template <typename U, typename... Args>
+	friend gc_ptr<U> make_gc(Args&&... args);
+
+public:
+	gc_ptr() = default;
+	gc_ptr(std::nullptr_t) {}
+
+	~gc_ptr() { reset(); }
+
+	gc_ptr(const gc_ptr& copy)
+	{
+		m_object = copy.m_object;
+		if (m_object)
+			GcHeap::instance().increment(m_object);
+	}
+
+	gc_ptr(gc_ptr&& copy) noexcept
+	{
+		m_object = std::exchange(copy.m_object, nullptr);
+	}
+
+	gc_ptr& operator=(const gc_ptr& copy)
+	{
+		if (copy.m_object)
+			GcHeap::instance().increment(copy.m_object); // before reset(), in case both point at the same object
+		reset();
+		m_object = copy.m_object;
+
+		return *this;
+	}
+
+	gc_ptr& operator=(gc_ptr&& copy) noexcept
+	{
+		if (this == &copy)
+			return *this;
+
+		reset();
+		m_object = std::exchange(copy.m_object, nullptr);
+
+		return *this;
+	}
+
+	void reset()
+	{
+		if (m_object)
+			GcHeap::instance().decrement(std::exchange(m_object, nullptr));
+	}
+
+	T* get() const { return static_cast<T*>(m_object); }
+	T& operator*() const { return *get(); }
+	T* operator->() const { return get(); }
+	explicit operator bool() const { return m_object != nullptr; }
+};
+
+template <typename T, typename... Args>
+gc_ptr<T> make_gc(Args&&... args)
+{
+	T* object { new T(std::forward<Args>(args)...) };
+	GcHeap::instance().track(object, sizeof(T));
+	return gc_ptr<T>{ object };
+}
+
+// The Person from note 1, with a gc_ptr partner : the cycle no longer leaks
+class Person : public GcObject
+{
+	std::string m_name;
+	gc_ptr<Person> m_partner;
+
+public:
+	Person(const std::string &name) : m_name(name)
+	{
+		std::cout << m_name << " created\n";
+	}
+	~Person()
+	{
+		std::cout << m_name << " destroyed\n";
+	}
+
+	void trace(GcVisitor& visitor) override { visitor(m_partner); }
+
+	friend bool partnerUp(gc_ptr<Person> &p1, gc_ptr<Person> &p2)
+	{
+		if (!p1 || !p2)
+			return false;
+
+		p1->m_partner = p2;
+		p2->m_partner = p1;
+
+		std::cout << p1->m_name << " is now partnered with " << p2->m_name << '\n';
+
+		return true;
+	}
+};
+
+// A quiet member of a social graph, following a few others
+struct Member : GcObject
+{
+	gc_ptr<Member> m_follows[3] {};
+	int m_profile[16] {};
+
+	void trace(GcVisitor& visitor) override
+	{
+		for (auto& follow : m_follows)
+			visitor(follow);
+	}
+};
+
+// Something expensive to build
+struct DecodedImage
+{
+	std::string m_name {};
+	std::vector<int> m_pixels {};
+
+	explicit DecodedImage(const std::string& name) : m_name{ name }, m_pixels(64 * 64)
+	{
+		for (std::size_t i = 0; i < m_pixels.size(); ++i)
+			m_pixels[i] = static_cast<int>((i * 2654435761u) >> 8);
+	}
+};
 class Resource
 {
 public:
@@ -248,5 +979,90 @@ int main()
 	auto weak{ getWeakPtr() };
 	std::cout << "Our weak ptr is: " << ((weak.expired()) ? "expired\n" : "valid\n");
 
+	{
+		WeakCache<std::string, DecodedImage> cache { 2, 1 }; // strong tier of 2, one shard
+		auto decode = [](const std::string& name) {
+			return [name] { return std::make_shared<DecodedImage>(name); };
+		};
+
+		auto held { cache.getOrCreate("held.png", decode("held.png")) };   // a client keeps this one
+		cache.getOrCreate("a.png", decode("a.png"));
+		cache.getOrCreate("b.png", decode("b.png"));
+		cache.find("b.png");                                             // b.png was used recently
+		cache.getOrCreate("c.png", decode("c.png"));                     // evicts from the strong tier
+
+		for (const char* name : { "held.png", "a.png", "b.png", "c.png" })
+			std::cout << name << " is " << (cache.find(name) ? "cached\n" : "gone\n");
+	}
+
+	// 4 threads looking up 64 images, with no strong tier (only what clients hold survives) and with room for all of them
+	for (int strongCapacity : { 0, 64 })
+	{
+		WeakCache<int, DecodedImage> cache { strongCapacity };
+		std::atomic<long long> decodes {};
+
+		auto start { std::chrono::steady_clock::now() };
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t)
+		{
+			threads.emplace_back([&cache, &decodes, t] {
+				unsigned int seed { 12345u + t };
+				for (int i = 0; i < 20000; ++i)
+				{
+					seed = seed * 1664525u + 1013904223u;
+					int key { static_cast<int>(seed >> 16) % 64 };
+					auto image { cache.getOrCreate(key, [&] {
+						decodes.fetch_add(1, std::memory_order_relaxed);
+						return std::make_shared<DecodedImage>(std::to_string(key));
+					}) };
+					(void)image->m_pixels[0];
+				}
+			});
+		}
+		for (auto& thread : threads)
+			thread.join();
+		std::chrono::duration<double, std::milli> elapsed { std::chrono::steady_clock::now() - start };
+
+		std::cout << "strong tier of " << strongCapacity << " : 80000 lookups in " << elapsed.count() << " ms : " << cache.getHits() << " hits, "
+				  << decodes << " decodes, " << cache.getLiveCount() << " images alive\n";
+	}
+
+	{
+		auto lucy { make_gc<Person>("Lucy") };
+		auto ricky { make_gc<Person>("Ricky") };
+
+		partnerUp(lucy, ricky);
+	} // the cycle keeps both alive, for now
+
+	GcStats stats { GcHeap::instance().collect() };
+	std::cout << "Collected " << stats.objectsReclaimed << " objects, " << stats.bytesReclaimed << " bytes\n";
+
+	{
+		// 50000 small friend groups, each group following itself around in circles
+		std::vector<gc_ptr<Member>> members(200000);
+		for (auto& member : members)
+			member = make_gc<Member>();
+		for (std::size_t i = 0; i < members.size(); ++i)
+		{
+			std::size_t group { i / 4 * 4 };
+			for (std::size_t f = 0; f < 3; ++f)
+				members[i]->m_follows[f] = members[group + (i + f + 1) % 4];
+		}
+	} // no outside owner left, 200000 candidates
+
+	std::cout << GcHeap::instance().getCandidateCount() << " candidates, collecting in 1 ms steps\n";
+	int steps {};
+	double longestStep {};
+	long long bytes {};
+	while (GcHeap::instance().getCandidateCount() > 0)
+	{
+		auto start { std::chrono::steady_clock::now() };
+		bytes += GcHeap::instance().collectStep(std::chrono::microseconds{ 1000 }).bytesReclaimed;
+		std::chrono::duration<double, std::milli> step { std::chrono::steady_clock::now() - start };
+		longestStep = std::max(longestStep, step.count());
+		++steps;
+	}
+	std::cout << steps << " steps, longest " << longestStep << " ms, " << bytes << " bytes reclaimed\n";
+
 	return 0;
 }
\ No newline at end of file
@@ -91,9 +91,322 @@
 
     7. Composition and class members : A good rule of thumb is that each class should be built to accomplish a single task. That task should either be the storage and manipulation of some kind of data (e.g. Point2D, std::string), OR the coordination of its members (e.g. Creature). Ideally not both.
 
-    
+    8. A world of a million creatures (CreatureWorld) :
+
+        - A std::vector<Creature> stores each creature as a name (a std::string, possibly with its own heap block) followed by its Point2D. Code that only cares about positions ("who is near (500, 500) ?") still drags every name through the cache, and has to look at every creature.
+
+        - Structure of arrays (SoA) : CreatureWorld composes the same parts differently, one array per member instead of one object per creature :
+
+            names : [ "Marvin", "Zaphod", ... ]
+            xs    : [ 4, 120, ... ]
+            ys    : [ 7, 33, ... ]
+
+            A creature is just an index into these arrays. getCreature(id) still gives back a Creature when one is needed.
+
+        - Uniform grid : the world is cut into square cells of cellSize x cellSize, and each cell keeps the (x, y, id) of the creatures in it, contiguous. A box query only looks at the cells the box overlaps, a radius query at the cells overlapping the circle's bounding box, and only then compares coordinates. With creatures spread evenly, the work depends on the size of the query, not on the number of creatures in the world.
+
+        - moveTo() updates the grid as it goes : each creature remembers its cell and its position in the cell, so moving inside the same cell only rewrites (x, y), and changing cells is a swap with the last entry of the old cell and a push_back in the new one. Both are O(1). moveMany() applies a whole tick of moves in one call.
+
+        - Pick cellSize close to the size of a typical query : too big and each cell holds many creatures to test, too small and a query visits many empty cells. Creatures outside of the world's bounds are kept in the border cells, so they are still found.
+
 */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+class Point2D
+{
+private:
+    int m_x;
+    int m_y;
+
+public:
+    // A default constructor
+    Point2D()
+        : m_x{ 0 }, m_y{ 0 }
+    {
+    }
+
+    // A specific constructor
+    Point2D(int x, int y)
+        : m_x{ x }, m_y{ y }
+    {
+    }
+
+    // An overloaded output operator
+    friend std::ostream& operator<<(std::ostream& out, const Point2D& point)
+    {
+        out << '(' << point.m_x << ", " << point.m_y << ')';
+        return out;
+    }
+
+    // Access functions
+    void setPoint(int x, int y)
+    {
+        m_x = x;
+        m_y = y;
+    }
+
+    int getX() const { return m_x; }
+    int getY() const { return m_y; }
+};
+
+class Creature
+{
+private:
+    std::string m_name;
+    Point2D m_location;
+
+public:
+    Creature(std::string_view name, const Point2D& location)
+        : m_name{ name }, m_location{ location }
+    {
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const Creature& creature)
+    {
+        out << creature.m_name << " is at " << creature.m_location;
+        return out;
+    }
+
+    void moveTo(int x, int y)
+    {
+        m_location.setPoint(x, y);
+    }
+
+    const std::string& getName() const { return m_name; }
+    const Point2D& getLocation() const { return m_location; }
+};
+
+class CreatureWorld
+{
+private:
+    struct CellEntry
+    {
+        int x;
+        int y;
+        int id;
+    };
+
+    // one array per member of Creature, plus where each creature is in the grid
+    std::vector<std::string> m_names{};
+    std::vector<int> m_xs{};
+    std::vector<int> m_ys{};
+    std::vector<int> m_cellOf{};
+    std::vector<int> m_indexInCell{};
+
+    int m_cellSize;
+    int m_columns;
+    int m_rows;
+    std::vector<std::vector<CellEntry>> m_cells;
+
+    int columnOf(int x) const { return std::clamp(x / m_cellSize, 0, m_columns - 1); }
+    int rowOf(int y) const { return std::clamp(y / m_cellSize, 0, m_rows - 1); }
+    int cellAt(int x, int y) const { return rowOf(y) * m_columns + columnOf(x); }
+
+    void addToCell(int id, int cell)
+    {
+        m_cellOf[id] = cell;
+        m_indexInCell[id] = static_cast<int>(m_cells[cell].size());
+        m_cells[cell].push_back({ m_xs[id], m_ys[id], id });
+    }
+
+    void removeFromCell(int id)
+    {
+        std::vector<CellEntry>& cell { m_cells[m_cellOf[id]] };
+        int index { m_indexInCell[id] };
+        cell[index] = cell.back();
+        m_indexInCell[cell[index].id] = index;
+        cell.pop_back();
+    }
+
+    // call f(entry) for every creature in the cells overlapping the box
+    template <typename F>
+    void forEachInCells(int minX, int minY, int maxX, int maxY, F f) const
+    {
+        int lastRow { rowOf(maxY) };
+        int lastColumn { columnOf(maxX) };
+        for (int row = rowOf(minY); row <= lastRow; ++row)
+            for (int column = columnOf(minX); column <= lastColumn; ++column)
+                for (const CellEntry& entry : m_cells[row * m_columns + column])
+                    f(entry);
+    }
+
+public:
+    CreatureWorld(int width, int height, int cellSize)
+        : m_cellSize{ cellSize },
+          m_columns{ std::max(1, (width + cellSize - 1) / cellSize) },
+          m_rows{ std::max(1, (height + cellSize - 1) / cellSize) },
+          m_cells(static_cast<std::size_t>(m_columns) * m_rows)
+    {
+    }
+
+    int add(std::string_view name, const Point2D& location)
+    {
+        int id { static_cast<int>(m_names.size()) };
+        m_names.emplace_back(name);
+        m_xs.push_back(location.getX());
+        m_ys.push_back(location.getY());
+        m_cellOf.push_back(0);
+        m_indexInCell.push_back(0);
+        addToCell(id, cellAt(location.getX(), location.getY()));
+
+        return id;
+    }
+
+    void moveTo(int id, int x, int y)
+    {
+        m_xs[id] = x;
+        m_ys[id] = y;
+
+        int cell { cellAt(x, y) };
+        if (cell == m_cellOf[id])
+        {
+            CellEntry& entry { m_cells[cell][m_indexInCell[id]] };
+            entry.x = x;
+            entry.y = y;
+            return;
+        }
+
+        removeFromCell(id);
+        addToCell(id, cell);
+    }
+
+    // ids[i] moves to locations[i]
+    void moveMany(std::span<const int> ids, std::span<const Point2D> locations)
+    {
+        for (std::size_t i = 0; i < ids.size(); ++i)
+            moveTo(ids[i], locations[i].getX(), locations[i].getY());
+    }
+
+    // ids of the creatures with minX <= x <= maxX and minY <= y <= maxY, appended to out
+    void queryBox(int minX, int minY, int maxX, int maxY, std::vector<int>& out) const
+    {
+        forEachInCells(minX, minY, maxX, maxY, [&](const CellEntry& entry) {
+            if (entry.x >= minX && entry.x <= maxX && entry.y >= minY && entry.y <= maxY)
+                out.push_back(entry.id);
+        });
+    }
+
+    // ids of the creatures at most radius away from (x, y), appended to out
+    void queryRadius(int x, int y, int radius, std::vector<int>& out) const
+    {
+        long long radiusSquared { static_cast<long long>(radius) * radius };
+        forEachInCells(x - radius, y - radius, x + radius, y + radius, [&](const CellEntry& entry) {
+            long long dx { entry.x - x };
+            long long dy { entry.y - y };
+            if (dx * dx + dy * dy <= radiusSquared)
+                out.push_back(entry.id);
+        });
+    }
+
+    Creature getCreature(int id) const { return Creature{ m_names[id], Point2D{ m_xs[id], m_ys[id] } }; }
+    Point2D getLocation(int id) const { return Point2D{ m_xs[id], m_ys[id] }; }
+    const std::string& getName(int id) const { return m_names[id]; }
+    int getCount() const { return static_cast<int>(m_names.size()); }
+};
+
 int main()
 {
+    Creature marvin{ "Marvin", Point2D{ 4, 7 } };
+    marvin.moveTo(5, 2);
+    std::cout << marvin << '\n';
+
+    CreatureWorld small{ 100, 100, 10 };
+    small.add("Marvin", Point2D{ 4, 7 });
+    small.add("Zaphod", Point2D{ 50, 50 });
+    small.add("Ford", Point2D{ 12, 3 });
+    small.moveTo(1, 8, 9); // Zaphod comes over
+
+    std::vector<int> near{};
+    small.queryRadius(5, 5, 8, near);
+    for (int id : near)
+        std::cout << small.getCreature(id) << " (near (5, 5))\n";
+
+    // 1000000 creatures in a 100000 x 100000 world
+    constexpr int worldSize { 100000 };
+    constexpr int creatureCount { 1000000 };
+    std::mt19937 rng{ 7 };
+    std::uniform_int_distribution<int> coordinate{ 0, worldSize - 1 };
+
+    std::vector<Creature> creatures{};
+    creatures.reserve(creatureCount);
+    CreatureWorld world{ worldSize, worldSize, 500 };
+    for (int i = 0; i < creatureCount; ++i)
+    {
+        Point2D location{ coordinate(rng), coordinate(rng) };
+        creatures.emplace_back("Creature " + std::to_string(i), location);
+        world.add(creatures.back().getName(), location);
+    }
+
+    // 100 box queries of 2000 x 2000 (about 400 creatures each)
+    std::vector<Point2D> corners(100);
+    for (Point2D& corner : corners)
+        corner = Point2D{ coordinate(rng), coordinate(rng) };
+
+    Timer t;
+    long long found{};
+    for (const Point2D& corner : corners)
+    {
+        for (const Creature& creature : creatures)
+        {
+            const Point2D& location { creature.getLocation() };
+            found += location.getX() >= corner.getX() && location.getX() <= corner.getX() + 2000
+                  && location.getY() >= corner.getY() && location.getY() <= corner.getY() + 2000;
+        }
+    }
+    std::cout << "box query, every Creature : " << t.elapsed() / 1e6 / 100 << " ms (" << found << " found)\n";
+
+    t.reset();
+    std::vector<int> inBox{};
+    for (const Point2D& corner : corners)
+        world.queryBox(corner.getX(), corner.getY(), corner.getX() + 2000, corner.getY() + 2000, inBox);
+    std::cout << "box query, grid           : " << t.elapsed() / 1e6 / 100 << " ms (" << inBox.size() << " found)\n";
+
+    // one tick : every creature takes a small random step
+    std::vector<int> ids(creatureCount);
+    std::vector<Point2D> steps(creatureCount);
+    std::uniform_int_distribution<int> step{ -50, 50 };
+    for (int id = 0; id < creatureCount; ++id)
+    {
+        ids[id] = id;
+        Point2D location { world.getLocation(id) };
+        steps[id] = Point2D{ location.getX() + step(rng), location.getY() + step(rng) };
+    }
+
+    t.reset();
+    world.moveMany(ids, steps);
+    std::cout << "moveMany of " << creatureCount << " creatures : " << t.elapsed() / 1e6 << " ms\n";
+
+    t.reset();
+    std::vector<int> inRadius{};
+    world.queryRadius(worldSize / 2, worldSize / 2, 1000, inRadius);
+    std::cout << "radius query of 1000      : " << t.elapsed() / 1e6 << " ms (" << inRadius.size() << " found)\n";
+
     return 0;
 }
\ No newline at end of file
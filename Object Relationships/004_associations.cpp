@@ -233,9 +233,1126 @@
         Directionality	                             Unidirectional	| Unidirectional| Unidirectional or bidirectional
         Relationship verb	                                Part-of	|    Has-a	    |  Uses-a
 
+    6. Making ID lookups fast (CarIndex) :
+
+        - CarLot::getCar() in note 4 compares the id with every car : O(n) for every Driver to Car lookup. With a million cars, that is a million comparisons for one lookup.
+
+        - CarIndex is an open addressing hash table in the style of Abseil's SwissTable, mapping an id to its Car* :
+
+            = Next to the slots there is an array of one byte "control" entries : 0x80 for an empty slot, or the top 7 bits of the id's hash (the tag) for a full one.
+            = The id is hashed with the splitmix64 finalizer, which mixes every bit of the id into every bit of the hash. The group comes from the low bits and the tag from the top 7, so they don't overlap. A plain multiply (Fibonacci hashing) would not do : the low bits of a product only depend on the low bits of the id, so ids with a stride of 1024 or 4096 would all land in a few groups and probe long chains.
+            = Slots are grouped by 16. A lookup hashes the id once, picks a group, and compares the 7 bit tag with all 16 control bytes of the group in a single SSE2 instruction (_mm_cmpeq_epi8). Only the slots whose tag matches (almost always 0 or 1 of them) are compared with the id. If the group has an empty slot, the id is not in the table, otherwise the next group is probed.
+            = The table grows (doubles) when it is 7/8 full, so a lookup rarely looks at more than one group.
+
+        - Dense mode : when the ids are a small contiguous range (say 1000 to 51000 for 50000 cars), no hashing is needed at all : the Car* for id is simply dense[id - minId]. CarIndex picks this mode when the range is at most 2x the number of cars, and switches to the hash table if an id outside the range is inserted.
+
+        - Batch lookups with prefetch : resolving many ids one after the other, each lookup waits on a cache miss (for the control group, then the slot). getCars() computes the position of the id 16 elements ahead and asks the CPU to start loading it (__builtin_prefetch), so by the time we get there the memory has arrived, and several misses are in flight at once.
+
+            int ids[] { 17, 84, 4 };
+            Car* cars[3] {};
+            CarLot::getCars(ids, cars);
+
+        - Cars are never removed from the index (the lot is a fixed array), which also means no "deleted" markers are needed in the control bytes.
+
+    7. Small handles instead of ids and pointers (HandleRegistry) :
+
+        - Note 4 mentions that an 8 or 16 bit id takes much less room than an 8 byte pointer. A plain id has a problem though : when the car with id 17 is sold and another car later gets id 17, every Driver still holding 17 now silently refers to the wrong car (the id version of a dangling pointer).
+
+        - HandleRegistry<T, IndexBits, GenerationBits> stores the objects and hands out handles of IndexBits + GenerationBits bits (2 bytes up to 16 bits, 4 bytes up to 32) :
+
+            = index : which slot of the registry the object lives in.
+            = generation : a counter stored in the slot too, incremented each time the slot's object is erased. A handle only resolves if its generation matches the slot's, so an old handle to a reused slot resolves to nullptr instead of to the new object.
+
+        - When a slot's generation counter would wrap around to a value old handles might still hold, the slot is retired (never reused), so a stale handle can never resolve to a new object.
+
+        - Storage is a slot map : the objects themselves are kept contiguous in a std::vector (iterating over all of them is a plain array walk), and each slot stores where its object is. Erasing moves the last object into the hole and fixes that object's slot. insert(), erase() and get() are all O(1).
+
+            HandleRegistry<Car, 12> fleet;              // up to 4096 cars, 4 bit generations, 2 byte handles
+            auto prius { fleet.insert("Prius", 4) };
+            fleet.get(prius);                           // Car*
+            fleet.erase(prius);
+            fleet.get(prius);                           // nullptr, even if the slot is reused
+
+        - The price is one extra indirection (slot, then object) compared to a pointer, and a pointer returned by get() is only valid until the next insert or erase, since objects move.
+
+    8. Many to many associations in bulk (DoctorPatientGraph) :
+
+        - The Doctor / Patient example in note 2 gives every object its own std::vector of std::reference_wrapper : two heap blocks per pair of objects, scattered all over memory. Walking every doctor's patients jumps from block to block, and each jump is likely a cache miss.
+
+        - Compressed sparse row (CSR) : number the doctors and the patients 0, 1, 2, ... and put all of the associations in one array, sorted by doctor, with a second array saying where each doctor's part starts :
+
+            patients of doctor d  =  patientIds[offsets[d]] ... patientIds[offsets[d + 1] - 1]
+
+                offsets    : 0 1 3 3              (3 doctors : James, Scott, Nobody)
+                patientIds : 0 0 2                (James : Dave, Scott : Dave, Betsy)
+
+            = the number of patients of a doctor is offsets[d + 1] - offsets[d] : O(1).
+            = a doctor's patients are a contiguous std::span<const int>, and walking all of the doctors reads both arrays from start to end, which is the access pattern memory is fastest at.
+            = the same is stored the other way around (doctors of each patient), so the association stays bidirectional.
+
+        - The arrays are built in one go from a list of (doctor, patient) pairs with a counting sort : count the pairs per doctor, turn the counts into offsets (a prefix sum), then drop every pair in its place. O(doctors + patients + pairs).
+
+        - Adding a pair to a CSR array means shifting everything after it, so new pairs go to a delta log instead. The log is threaded into a linked list per node : one int head per node and one int next per pair, in flat arrays (no heap vector per node). getPatientCount() includes the pending pairs, forEachPatient() visits them too (by following the node's own list, so visiting every node stays O(pairs), not O(nodes x log)), but getPatients() only returns the merged span. merge() rebuilds the arrays with the log in place (also O(everything), but no allocation once the vectors are big enough), and connect() does that automatically once the log holds 1/8 as many pairs as the arrays, so the cost of a merge is spread over many inserts.
+
+    9. Prerequisite chains (PrerequisiteGraph) :
+
+        - The Course in note 3 has a single prerequisite pointer, and finding out whether Algorithms requires Programming 101 somewhere down the chain means following the pointers every time : O(depth). Real courses have several prerequisites, which makes that a graph search.
+
+        - PrerequisiteGraph allows any number of prerequisites per course, and keeps the transitive closure : for every course, a bitset with bit p set if p is required directly or indirectly. isRequired(a, b) is then a single bit test.
+
+        - Cycles : a course can't (indirectly) require itself. addPrerequisite(course, prerequisite) refuses the edge (returns false, nothing changes) if prerequisite already requires course, which the closure answers in O(1) too. Since the graph never has a cycle, a topological order (every course after all of its prerequisites) always exists, and getTopologicalOrder() computes one with Kahn's algorithm.
+
+        - Keeping the closure up to date :
+
+            = adding course -> prerequisite : every course that requires course (and course itself) now also requires prerequisite and all that prerequisite requires. That is one OR of two bitsets per affected course, 64 courses per instruction.
+            = removing an edge : requirements can disappear, but only for course and the courses requiring it. Their rows are rebuilt from their direct prerequisites, prerequisites first (topological order), while all other rows are left alone.
+
+        - Memory is n * n bits : 10000 courses take 12.5 MB.
 
 */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+class Car
+{
+private:
+    std::string m_name{};
+    int m_id{};
+
+public:
+    Car(std::string_view name, int id)
+        : m_name{ name }, m_id{ id }
+    {
+    }
+
+    const std::string& getName() const { return m_name; }
+    int getId() const { return m_id; }
+};
+
+class CarIndex
+{
+private:
+    static constexpr int groupSize { 16 };
+    static constexpr std::int8_t empty { static_cast<std::int8_t>(0x80) };
+    static constexpr int prefetchDistance { 16 };
+
+    struct Slot
+    {
+        int id;
+        Car* car;
+    };
+
+    // dense mode : m_dense[id - m_minId]
+    bool m_isDense{ true };
+    int m_minId{};
+    std::vector<Car*> m_dense{};
+
+    // hash mode : m_control[i] describes m_slots[i]
+    std::vector<std::int8_t> m_control{};
+    std::vector<Slot> m_slots{};
+    std::size_t m_groupMask{};
+    std::size_t m_size{};
+
+    static std::uint64_t hash(int id)
+    {
+        // splitmix64's finalizer : every bit of the id reaches every bit of the hash (see note 6)
+        std::uint64_t h { static_cast<std::uint64_t>(static_cast<std::uint32_t>(id)) };
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        return h ^ (h >> 31);
+    }
+
+    // the top 7 bits, the group uses the low ones
+    static std::int8_t tagOf(std::uint64_t h) { return static_cast<std::int8_t>(h >> 57); }
+    std::size_t groupOf(std::uint64_t h) const { return static_cast<std::size_t>(h) & m_groupMask; }
+
+    // bit i set : control byte i of the group equals tag
+    static std::uint32_t matchGroup(const std::int8_t* group, std::int8_t tag)
+    {
+#if defined(__SSE2__)
+        __m128i control { _mm_loadu_si128(reinterpret_cast<const __m128i*>(group)) };
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(tag))));
+#else
+        std::uint32_t mask{};
+        for (int i = 0; i < groupSize; ++i)
+            mask |= static_cast<std::uint32_t>(group[i] == tag) << i;
+        return mask;
+#endif
+    }
+
+    Car* findHashed(int id, std::uint64_t h) const
+    {
+        if (m_slots.empty())
+            return nullptr;
+
+        std::size_t group { groupOf(h) };
+        std::int8_t tag { tagOf(h) };
+        for (std::size_t probe = 1; ; ++probe)
+        {
+            const std::int8_t* control { &m_control[group * groupSize] };
+            for (std::uint32_t match { matchGroup(control, tag) }; match != 0; match &= match - 1)
+            {
+                const Slot& slot { m_slots[group * groupSize + static_cast<std::size_t>(__builtin_ctz(match))] };
+                if (slot.id == id)
+                    return slot.car;
+            }
+
+            if (matchGroup(control, empty) != 0)
+                return nullptr;
+
+            group = (group + probe) & m_groupMask; // triangular probing visits every group
+        }
+    }
+
+    void insertHashed(Car* car)
+    {
+        std::uint64_t h { hash(car->getId()) };
+        std::size_t group { groupOf(h) };
+        for (std::size_t probe = 1; ; ++probe)
+        {
+            std::uint32_t free { matchGroup(&m_control[group * groupSize], empty) };
+            if (free != 0)
+            {
+                std::size_t i { group * groupSize + static_cast<std::size_t>(__builtin_ctz(free)) };
+                m_control[i] = tagOf(h);
+                m_slots[i] = Slot{ car->getId(), car };
+                ++m_size;
+                return;
+            }
+            group = (group + probe) & m_groupMask;
+        }
+    }
+
+    void rehash(std::size_t groups)
+    {
+        std::vector<Car*> cars{};
+        cars.reserve(m_size);
+        for (std::size_t i = 0; i < m_slots.size(); ++i)
+            if (m_control[i] != empty)
+                cars.push_back(m_slots[i].car);
+
+        m_control.assign(groups * groupSize, empty);
+        m_slots.assign(groups * groupSize, Slot{ 0, nullptr });
+        m_groupMask = groups - 1;
+        m_size = 0;
+        for (Car* car : cars)
+            insertHashed(car);
+    }
+
+    void switchToHash()
+    {
+        std::vector<Car*> dense{};
+        dense.swap(m_dense);
+        m_isDense = false;
+
+        std::size_t groups { 1 };
+        while (groups * groupSize * 7 / 8 < m_size + 1)
+            groups *= 2;
+        m_size = 0;
+        rehash(groups);
+
+        for (Car* car : dense)
+            if (car)
+                insertHashed(car);
+    }
+
+public:
+    CarIndex() = default;
+
+    explicit CarIndex(std::span<Car> cars)
+    {
+        if (!cars.empty())
+        {
+            auto [low, high] { std::minmax_element(cars.begin(), cars.end(), [](const Car& a, const Car& b) { return a.getId() < b.getId(); }) };
+            long long range { static_cast<long long>(high->getId()) - low->getId() + 1 };
+            if (range <= 2 * static_cast<long long>(cars.size()))
+            {
+                m_minId = low->getId();
+                m_dense.assign(static_cast<std::size_t>(range), nullptr);
+            }
+            else
+            {
+                m_isDense = false;
+            }
+        }
+
+        if (!m_isDense)
+        {
+            std::size_t groups { 1 };
+            while (groups * groupSize * 7 / 8 < cars.size())
+                groups *= 2;
+            rehash(groups);
+        }
+
+        for (Car& car : cars)
+            insert(car);
+    }
+
+    // the car must outlive the index, an id already in the index is replaced
+    void insert(Car& car)
+    {
+        int id { car.getId() };
+        if (m_isDense)
+        {
+            if (m_dense.empty())
+                m_minId = id;
+
+            long long offset { static_cast<long long>(id) - m_minId };
+            if (offset >= 0 && offset < static_cast<long long>(m_dense.size()))
+            {
+                m_size += m_dense[static_cast<std::size_t>(offset)] == nullptr;
+                m_dense[static_cast<std::size_t>(offset)] = &car;
+                return;
+            }
+            if (m_dense.empty() && offset == 0)
+            {
+                m_dense.push_back(&car);
+                ++m_size;
+                return;
+            }
+            switchToHash();
+        }
+
+        std::uint64_t h { hash(id) };
+        std::size_t group { groupOf(h) };
+        for (std::size_t probe = 1; ; ++probe)
+        {
+            const std::int8_t* control { &m_control[group * groupSize] };
+            for (std::uint32_t match { matchGroup(control, tagOf(h)) }; match != 0; match &= match - 1)
+            {
+                Slot& slot { m_slots[group * groupSize + static_cast<std::size_t>(__builtin_ctz(match))] };
+                if (slot.id == id)
+                {
+                    slot.car = &car;
+                    return;
+                }
+            }
+            if (matchGroup(control, empty) != 0)
+                break;
+            group = (group + probe) & m_groupMask;
+        }
+
+        if ((m_size + 1) * 8 > m_slots.size() * 7)
+            rehash((m_groupMask + 1) * 2);
+        insertHashed(&car);
+    }
+
+    Car* find(int id) const
+    {
+        if (m_isDense)
+        {
+            long long offset { static_cast<long long>(id) - m_minId };
+            return offset >= 0 && offset < static_cast<long long>(m_dense.size()) ? m_dense[static_cast<std::size_t>(offset)] : nullptr;
+        }
+
+        return findHashed(id, hash(id));
+    }
+
+    // out[i] = find(ids[i]), loading the memory for later ids while resolving the current one
+    void findMany(std::span<const int> ids, std::span<Car*> out) const
+    {
+        if (m_isDense)
+        {
+            for (std::size_t i = 0; i < ids.size(); ++i)
+                out[i] = find(ids[i]);
+            return;
+        }
+
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (i + prefetchDistance < ids.size() && !m_slots.empty())
+            {
+                std::size_t group { groupOf(hash(ids[i + prefetchDistance])) };
+                __builtin_prefetch(&m_control[group * groupSize]);
+                __builtin_prefetch(&m_slots[group * groupSize]);
+            }
+            out[i] = findHashed(ids[i], hash(ids[i]));
+        }
+    }
+
+    bool isDense() const { return m_isDense; }
+    std::size_t getSize() const { return m_size; }
+};
+
+// Our CarLot is still just a static array of Cars, now with an index on top of it
+namespace CarLot
+{
+    Car carLot[4] { { "Prius", 4 }, { "Corolla", 17 }, { "Accord", 84 }, { "Matrix", 62 } };
+
+    const CarIndex& getIndex()
+    {
+        static const CarIndex index { carLot };
+        return index;
+    }
+
+    Car* getCar(int id)
+    {
+        return getIndex().find(id);
+    }
+
+    void getCars(std::span<const int> ids, std::span<Car*> out)
+    {
+        getIndex().findMany(ids, out);
+    }
+};
+
+class Driver
+{
+private:
+    std::string m_name{};
+    int m_carId{}; // we're associated with the Car by ID rather than pointer
+
+public:
+    Driver(std::string_view name, int carId)
+        : m_name{ name }, m_carId{ carId }
+    {
+    }
+
+    const std::string& getName() const { return m_name; }
+    int getCarId() const { return m_carId; }
+};
+
+template <typename T, int IndexBits, int GenerationBits = 16 - IndexBits>
+class HandleRegistry
+{
+    static_assert(IndexBits > 0 && GenerationBits > 0 && IndexBits + GenerationBits <= 32, "a handle is at most 32 bits");
+
+public:
+    using Storage = std::conditional_t<IndexBits + GenerationBits <= 16, std::uint16_t, std::uint32_t>;
+
+    class Handle
+    {
+    private:
+        Storage m_value{}; // generation 0 is never handed out, so the default handle never resolves
+
+        friend class HandleRegistry;
+
+        Handle(std::uint32_t index, std::uint32_t generation)
+            : m_value{ static_cast<Storage>((generation << IndexBits) | index) }
+        {
+        }
+
+        std::uint32_t getIndex() const { return m_value & ((1u << IndexBits) - 1); }
+        std::uint32_t getGeneration() const { return static_cast<std::uint32_t>(m_value) >> IndexBits; }
+
+    public:
+        Handle() = default;
+
+        explicit operator bool() const { return m_value != 0; }
+        friend bool operator==(Handle a, Handle b) { return a.m_value == b.m_value; }
+    };
+
+private:
+    static constexpr std::uint32_t maxSlots { 1u << IndexBits };
+    static constexpr std::uint32_t maxGeneration { (1u << GenerationBits) - 1 };
+    static constexpr std::uint32_t noSlot { ~0u };
+
+    struct Slot
+    {
+        std::uint32_t m_dense{};       // position of the object in m_values, or the next free slot
+        std::uint32_t m_generation{ 1 };
+    };
+
+    std::vector<Slot> m_slots{};
+    std::vector<T> m_values{};
+    std::vector<std::uint32_t> m_valueSlot{}; // m_valueSlot[i] : the slot of m_values[i]
+    std::uint32_t m_freeHead{ noSlot };
+    std::uint32_t m_retired{};
+
+    const Slot* findSlot(Handle handle) const
+    {
+        std::uint32_t index { handle.getIndex() };
+        if (index >= m_slots.size() || handle.getGeneration() == 0)
+            return nullptr;
+
+        const Slot& slot { m_slots[index] };
+        return slot.m_generation == handle.getGeneration() ? &slot : nullptr;
+    }
+
+public:
+    // Build a T in the registry. Throws std::length_error once every slot is in use or retired.
+    // If anything throws (T's constructor, or growing a vector), the registry is left as it was.
+    template <typename... Args>
+    Handle insert(Args&&... args)
+    {
+        bool reuse { m_freeHead != noSlot };
+        if (!reuse && m_slots.size() >= maxSlots)
+            throw std::length_error{ "HandleRegistry is full" };
+
+        std::uint32_t index { reuse ? m_freeHead : static_cast<std::uint32_t>(m_slots.size()) };
+
+        // the object first : if T's constructor throws, no slot has been touched yet
+        m_values.emplace_back(std::forward<Args>(args)...);
+        try
+        {
+            m_valueSlot.push_back(index);
+            if (!reuse)
+                m_slots.emplace_back();
+        }
+        catch (...)
+        {
+            if (m_valueSlot.size() == m_values.size())
+                m_valueSlot.pop_back();
+            m_values.pop_back();
+            throw;
+        }
+
+        // nothing below can throw
+        Slot& slot { m_slots[index] };
+        if (reuse)
+            m_freeHead = slot.m_dense;
+        slot.m_dense = static_cast<std::uint32_t>(m_values.size() - 1);
+
+        return Handle{ index, slot.m_generation };
+    }
+
+    // false if the handle was stale already
+    bool erase(Handle handle)
+    {
+        if (!findSlot(handle))
+            return false;
+
+        std::uint32_t index { handle.getIndex() };
+        Slot& slot { m_slots[index] };
+
+        // move the last object into the hole
+        std::uint32_t last { static_cast<std::uint32_t>(m_values.size() - 1) };
+        if (slot.m_dense != last)
+        {
+            m_values[slot.m_dense] = std::move(m_values[last]);
+            m_valueSlot[slot.m_dense] = m_valueSlot[last];
+            m_slots[m_valueSlot[last]].m_dense = slot.m_dense;
+        }
+        m_values.pop_back();
+        m_valueSlot.pop_back();
+
+        if (slot.m_generation == maxGeneration)
+        {
+            slot.m_generation = 0; // retired : no handle can match it any more
+            ++m_retired;
+        }
+        else
+        {
+            ++slot.m_generation;
+            slot.m_dense = m_freeHead;
+            m_freeHead = index;
+        }
+
+        return true;
+    }
+
+    // nullptr if the object was erased; the pointer is valid until the next insert or erase
+    T* get(Handle handle)
+    {
+        const Slot* slot { findSlot(handle) };
+        return slot ? &m_values[slot->m_dense] : nullptr;
+    }
+
+    const T* get(Handle handle) const
+    {
+        const Slot* slot { findSlot(handle) };
+        return slot ? &m_values[slot->m_dense] : nullptr;
+    }
+
+    bool contains(Handle handle) const { return findSlot(handle) != nullptr; }
+
+    std::size_t getSize() const { return m_values.size(); }
+    std::size_t getRetiredCount() const { return m_retired; }
+
+    // all of the objects, contiguous, in no particular order
+    auto begin() { return m_values.begin(); }
+    auto end() { return m_values.end(); }
+    auto begin() const { return m_values.begin(); }
+    auto end() const { return m_values.end(); }
+};
+
+class DoctorPatientGraph
+{
+public:
+    struct Edge
+    {
+        int doctor;
+        int patient;
+    };
+
+private:
+    int m_doctorCount{};
+    int m_patientCount{};
+
+    // merged associations, CSR in both directions
+    std::vector<int> m_doctorOffsets{ 0 };
+    std::vector<int> m_patientsOfDoctor{};
+    std::vector<int> m_patientOffsets{ 0 };
+    std::vector<int> m_doctorsOfPatient{};
+
+    // not merged yet : the log, threaded into one linked list per node (newest first) so a query only reads its own edges.
+    // A head per node and a next per edge, all flat : -1 ends a list
+    static constexpr int noEdge{ -1 };
+    std::vector<Edge> m_delta{};
+    std::vector<int> m_nextOfDoctor{};      // m_nextOfDoctor[e] : the doctor's previous pending edge
+    std::vector<int> m_nextOfPatient{};
+    std::vector<int> m_pendingHeadOfDoctor{};
+    std::vector<int> m_pendingHeadOfPatient{};
+
+    void buildAll(std::span<const Edge> edges)
+    {
+        buildRows(m_doctorCount, edges, [](const Edge& e) { return e.doctor; }, [](const Edge& e) { return e.patient; }, m_doctorOffsets, m_patientsOfDoctor);
+        buildRows(m_patientCount, edges, [](const Edge& e) { return e.patient; }, [](const Edge& e) { return e.doctor; }, m_patientOffsets, m_doctorsOfPatient);
+
+        m_delta.clear();
+        m_nextOfDoctor.clear();
+        m_nextOfPatient.clear();
+        m_pendingHeadOfDoctor.assign(static_cast<std::size_t>(m_doctorCount), noEdge);
+        m_pendingHeadOfPatient.assign(static_cast<std::size_t>(m_patientCount), noEdge);
+    }
+
+    // counting sort of the edges by key into offsets / values
+    template <typename Key, typename Value>
+    static void buildRows(int rowCount, std::span<const Edge> edges, Key key, Value value, std::vector<int>& offsets, std::vector<int>& values)
+    {
+        offsets.assign(static_cast<std::size_t>(rowCount) + 1, 0);
+        for (const Edge& edge : edges)
+            ++offsets[static_cast<std::size_t>(key(edge)) + 1];
+        for (int row = 0; row < rowCount; ++row)
+            offsets[row + 1] += offsets[row];
+
+        values.resize(edges.size());
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);
+        for (const Edge& edge : edges)
+            values[next[key(edge)]++] = value(edge);
+    }
+
+    static std::span<const int> row(const std::vector<int>& offsets, const std::vector<int>& values, int index)
+    {
+        if (index + 1 >= static_cast<int>(offsets.size()))
+            return {}; // added since the last merge
+        return { values.data() + offsets[index], static_cast<std::size_t>(offsets[index + 1] - offsets[index]) };
+    }
+
+public:
+    DoctorPatientGraph() = default;
+
+    DoctorPatientGraph(int doctorCount, int patientCount, std::span<const Edge> edges)
+        : m_doctorCount{ doctorCount }, m_patientCount{ patientCount }
+    {
+        buildAll(edges);
+    }
+
+    int addDoctor()
+    {
+        m_pendingHeadOfDoctor.push_back(noEdge);
+        return m_doctorCount++;
+    }
+
+    int addPatient()
+    {
+        m_pendingHeadOfPatient.push_back(noEdge);
+        return m_patientCount++;
+    }
+
+    void connect(int doctor, int patient)
+    {
+        int edge{ static_cast<int>(m_delta.size()) };
+        m_delta.push_back({ doctor, patient });
+        m_nextOfDoctor.push_back(std::exchange(m_pendingHeadOfDoctor[doctor], edge));
+        m_nextOfPatient.push_back(std::exchange(m_pendingHeadOfPatient[patient], edge));
+
+        if (m_delta.size() >= std::max<std::size_t>(1024, m_patientsOfDoctor.size() / 8))
+            merge();
+    }
+
+    // Fold the delta log into the CSR arrays
+    void merge()
+    {
+        if (m_delta.empty() && m_doctorOffsets.size() == static_cast<std::size_t>(m_doctorCount) + 1 && m_patientOffsets.size() == static_cast<std::size_t>(m_patientCount) + 1)
+            return;
+
+        std::vector<Edge> edges{};
+        edges.reserve(m_patientsOfDoctor.size() + m_delta.size());
+        for (int doctor = 0; doctor + 1 < static_cast<int>(m_doctorOffsets.size()); ++doctor)
+            for (int patient : row(m_doctorOffsets, m_patientsOfDoctor, doctor))
+                edges.push_back({ doctor, patient });
+        edges.insert(edges.end(), m_delta.begin(), m_delta.end());
+
+        buildAll(edges); // in place : the vectors keep their capacity
+    }
+
+    // merged patients only, see forEachPatient()
+    std::span<const int> getPatients(int doctor) const { return row(m_doctorOffsets, m_patientsOfDoctor, doctor); }
+    std::span<const int> getDoctors(int patient) const { return row(m_patientOffsets, m_doctorsOfPatient, patient); }
+
+    int getPatientCount(int doctor) const
+    {
+        int count{ static_cast<int>(getPatients(doctor).size()) };
+        for (int edge{ m_pendingHeadOfDoctor[doctor] }; edge != noEdge; edge = m_nextOfDoctor[edge])
+            ++count;
+        return count;
+    }
+
+    int getDoctorCount(int patient) const
+    {
+        int count{ static_cast<int>(getDoctors(patient).size()) };
+        for (int edge{ m_pendingHeadOfPatient[patient] }; edge != noEdge; edge = m_nextOfPatient[edge])
+            ++count;
+        return count;
+    }
+
+    // merged patients first, then the pending ones, newest first
+    template <typename F>
+    void forEachPatient(int doctor, F f) const
+    {
+        for (int patient : getPatients(doctor))
+            f(patient);
+        for (int edge{ m_pendingHeadOfDoctor[doctor] }; edge != noEdge; edge = m_nextOfDoctor[edge])
+            f(m_delta[edge].patient);
+    }
+
+    template <typename F>
+    void forEachDoctor(int patient, F f) const
+    {
+        for (int doctor : getDoctors(patient))
+            f(doctor);
+        for (int edge{ m_pendingHeadOfPatient[patient] }; edge != noEdge; edge = m_nextOfPatient[edge])
+            f(m_delta[edge].doctor);
+    }
+
+    int getDoctorTotal() const { return m_doctorCount; }
+    int getPatientTotal() const { return m_patientCount; }
+    std::size_t getPendingCount() const { return m_delta.size(); }
+};
+
+class PrerequisiteGraph
+{
+private:
+    std::vector<std::string> m_names{};
+    std::vector<std::vector<int>> m_prerequisites{};   // direct
+    std::vector<std::uint64_t> m_closure{};            // m_words words per course
+    std::size_t m_words{};
+
+    std::uint64_t* row(int course) { return &m_closure[static_cast<std::size_t>(course) * m_words]; }
+    const std::uint64_t* row(int course) const { return &m_closure[static_cast<std::size_t>(course) * m_words]; }
+
+    static bool testBit(const std::uint64_t* bits, int index) { return (bits[index / 64] >> (index % 64)) & 1; }
+    static void setBit(std::uint64_t* bits, int index) { bits[index / 64] |= std::uint64_t{ 1 } << (index % 64); }
+
+    // course's row from its direct prerequisites, which must be up to date
+    void rebuildRow(int course)
+    {
+        std::uint64_t* bits { row(course) };
+        std::fill(bits, bits + m_words, 0);
+        for (int prerequisite : m_prerequisites[course])
+        {
+            const std::uint64_t* other { row(prerequisite) };
+            for (std::size_t w = 0; w < m_words; ++w)
+                bits[w] |= other[w];
+            setBit(bits, prerequisite);
+        }
+    }
+
+public:
+    int addCourse(std::string_view name)
+    {
+        int course { static_cast<int>(m_names.size()) };
+        m_names.emplace_back(name);
+        m_prerequisites.emplace_back();
+
+        std::size_t words { (m_names.size() + 63) / 64 };
+        if (words > m_words)
+        {
+            // widen every row, doubling so that this is rare
+            std::size_t newWords { std::max(words, 2 * m_words) };
+            std::vector<std::uint64_t> closure(m_names.size() * newWords);
+            for (int c = 0; c < course; ++c)
+                std::copy_n(row(c), m_words, &closure[static_cast<std::size_t>(c) * newWords]);
+            m_closure.swap(closure);
+            m_words = newWords;
+        }
+        m_closure.resize(m_names.size() * m_words);
+
+        return course;
+    }
+
+    // false (and nothing changes) if the edge would make a cycle
+    bool addPrerequisite(int course, int prerequisite)
+    {
+        if (course == prerequisite || isRequired(prerequisite, course))
+            return false;
+        if (std::find(m_prerequisites[course].begin(), m_prerequisites[course].end(), prerequisite) != m_prerequisites[course].end())
+            return true;
+
+        m_prerequisites[course].push_back(prerequisite);
+
+        // copy, since prerequisite's row is never one of the rows we change (no cycles)
+        std::vector<std::uint64_t> added(row(prerequisite), row(prerequisite) + m_words);
+        setBit(added.data(), prerequisite);
+
+        for (int other = 0; other < getCourseCount(); ++other)
+        {
+            if (other != course && !isRequired(other, course))
+                continue;
+
+            std::uint64_t* bits { row(other) };
+            for (std::size_t w = 0; w < m_words; ++w)
+                bits[w] |= added[w];
+        }
+
+        return true;
+    }
+
+    void removePrerequisite(int course, int prerequisite)
+    {
+        auto& direct { m_prerequisites[course] };
+        auto it { std::find(direct.begin(), direct.end(), prerequisite) };
+        if (it == direct.end())
+            return;
+        direct.erase(it);
+
+        // only course and what requires it can lose requirements, rebuild those rows, prerequisites first
+        std::vector<std::uint8_t> affected(m_names.size());
+        affected[course] = 1;
+        for (int other = 0; other < getCourseCount(); ++other)
+            affected[other] |= isRequired(other, course);
+
+        for (int other : getTopologicalOrder())
+            if (affected[other])
+                rebuildRow(other);
+    }
+
+    // does course require prerequisite, directly or not
+    bool isRequired(int course, int prerequisite) const
+    {
+        return testBit(row(course), prerequisite);
+    }
+
+    // every course after all of its prerequisites (Kahn's algorithm)
+    std::vector<int> getTopologicalOrder() const
+    {
+        int count { getCourseCount() };
+        std::vector<int> missing(static_cast<std::size_t>(count));
+        std::vector<std::vector<int>> unlocks(static_cast<std::size_t>(count));
+        for (int course = 0; course < count; ++course)
+        {
+            missing[course] = static_cast<int>(m_prerequisites[course].size());
+            for (int prerequisite : m_prerequisites[course])
+                unlocks[prerequisite].push_back(course);
+        }
+
+        std::vector<int> order{};
+        order.reserve(static_cast<std::size_t>(count));
+        for (int course = 0; course < count; ++course)
+            if (missing[course] == 0)
+                order.push_back(course);
+
+        for (std::size_t next = 0; next < order.size(); ++next)
+            for (int course : unlocks[order[next]])
+                if (--missing[course] == 0)
+                    order.push_back(course);
+
+        return order;
+    }
+
+    const std::vector<int>& getPrerequisites(int course) const { return m_prerequisites[course]; }
+    const std::string& getName(int course) const { return m_names[course]; }
+    int getCourseCount() const { return static_cast<int>(m_names.size()); }
+};
+
+// note 3's way : search the direct prerequisites every time
+bool requiresBySearch(const PrerequisiteGraph& graph, int course, int prerequisite, std::vector<std::uint8_t>& seen)
+{
+    std::fill(seen.begin(), seen.end(), 0);
+    std::vector<int> stack{ course };
+    while (!stack.empty())
+    {
+        int next { stack.back() };
+        stack.pop_back();
+        for (int direct : graph.getPrerequisites(next))
+        {
+            if (direct == prerequisite)
+                return true;
+            if (!seen[direct])
+            {
+                seen[direct] = 1;
+                stack.push_back(direct);
+            }
+        }
+    }
+
+    return false;
+}
+
+// Up to 4096 cars, 2 byte handles
+using Fleet = HandleRegistry<Car, 12>;
+
+// A Driver associated with a Car by a generation checked handle
+class FleetDriver
+{
+private:
+    std::string m_name{};
+    Fleet::Handle m_car{};
+
+public:
+    FleetDriver(std::string_view name, Fleet::Handle car)
+        : m_name{ name }, m_car{ car }
+    {
+    }
+
+    const std::string& getName() const { return m_name; }
+    Fleet::Handle getCar() const { return m_car; }
+};
+
+// The linear scan from note 4, for comparison
+Car* findCarLinear(std::span<Car> cars, int id)
+{
+    for (auto& car : cars)
+    {
+        if (car.getId() == id)
+        {
+            return &car;
+        }
+    }
+
+    return nullptr;
+}
+
 int main()
 {
+    Driver d{ "Franz", 17 }; // Franz is driving the car with ID 17
+
+    Car* car{ CarLot::getCar(d.getCarId()) }; // Get that car from the car lot
+
+    if (car)
+        std::cout << d.getName() << " is driving a " << car->getName() << '\n';
+    else
+        std::cout << d.getName() << " couldn't find his car\n";
+
+    int ids[] { 84, 62, 5 };
+    Car* cars[3] {};
+    CarLot::getCars(ids, cars);
+    for (int i = 0; i < 3; ++i)
+        std::cout << "Car " << ids[i] << " : " << (cars[i] ? cars[i]->getName() : "not in the lot") << '\n';
+
+    {
+        Fleet fleet{};
+        FleetDriver franz{ "Franz", fleet.insert("Corolla", 17) };
+        FleetDriver betty{ "Betty", fleet.insert("Prius", 4) };
+
+        fleet.erase(franz.getCar());          // the Corolla is sold
+        Fleet::Handle reused { fleet.insert("Matrix", 62) }; // and its slot goes to the Matrix
+
+        for (const FleetDriver& driver : { franz, betty })
+        {
+            const Car* driven { fleet.get(driver.getCar()) };
+            std::cout << driver.getName() << (driven ? " is driving a " + driven->getName() : std::string{ " has no car any more" }) << '\n';
+        }
+        std::cout << "Franz's old slot now holds the " << fleet.get(reused)->getName() << ", handle size : " << sizeof(Fleet::Handle)
+                  << " bytes (a Car* is " << sizeof(Car*) << ")\n";
+
+        // 4 bit generations : a slot goes through generations 1 to 15, then it is retired instead of wrapping
+        HandleRegistry<int, 4, 4> tiny{};
+        for (int i = 0; i < 20; ++i)
+            tiny.erase(tiny.insert(i));
+        std::cout << "After 20 insert / erase : " << tiny.getRetiredCount() << " slot(s) retired\n";
+    }
+
+    std::mt19937 rng{ 42 };
+
+    {
+        // note 2's clinic, as a graph
+        const char* doctors[] { "James", "Scott" };
+        const char* patients[] { "Dave", "Frank", "Betsy" };
+        DoctorPatientGraph::Edge visits[] { { 0, 0 }, { 1, 0 }, { 1, 2 } };
+        DoctorPatientGraph clinic{ 2, 3, visits };
+
+        int nobody { clinic.addDoctor() };
+        clinic.connect(nobody, 1); // in the delta log for now
+
+        for (int doctor = 0; doctor < 2; ++doctor)
+        {
+            std::cout << doctors[doctor] << " is seeing patients: ";
+            for (int patient : clinic.getPatients(doctor))
+                std::cout << patients[patient] << ' ';
+            std::cout << '\n';
+        }
+        std::cout << "Frank is seeing " << clinic.getDoctorCount(1) << " doctor(s), " << clinic.getPendingCount() << " visit(s) not merged yet\n";
+    }
+
+    {
+        // 100000 doctors, 1000000 patients, 8000000 visits : one CSR graph vs a std::vector of patients per doctor
+        constexpr int doctorCount { 100000 };
+        constexpr int patientCount { 1000000 };
+        constexpr int visitCount { 8000000 };
+
+        std::vector<DoctorPatientGraph::Edge> visits(visitCount);
+        for (auto& visit : visits)
+            visit = { static_cast<int>(rng() % doctorCount), static_cast<int>(rng() % patientCount) };
+
+        std::vector<std::vector<int>> perDoctor(doctorCount);
+        for (const auto& visit : visits)
+            perDoctor[visit.doctor].push_back(visit.patient);
+        // the vectors end up scattered over the heap, like the per-object vectors of note 2
+        std::shuffle(perDoctor.begin(), perDoctor.end(), rng);
+
+        Timer t;
+        DoctorPatientGraph graph{ doctorCount, patientCount, visits };
+        std::cout << "CSR build of " << visitCount << " visits : " << t.elapsed() / 1e6 << " ms\n";
+
+        t.reset();
+        long long sum{};
+        for (const auto& patientsOfDoctor : perDoctor)
+            for (int patient : patientsOfDoctor)
+                sum += patient;
+        std::cout << "Walk, a vector per doctor : " << t.elapsed() / 1e6 << " ms (" << sum << ")\n";
+
+        t.reset();
+        sum = 0;
+        for (int doctor = 0; doctor < doctorCount; ++doctor)
+            for (int patient : graph.getPatients(doctor))
+                sum += patient;
+        std::cout << "Walk, CSR                 : " << t.elapsed() / 1e6 << " ms (" << sum << ")\n";
+
+        t.reset();
+        for (int i = 0; i < 100000; ++i)
+            graph.connect(static_cast<int>(rng() % doctorCount), static_cast<int>(rng() % patientCount));
+        std::cout << "100000 connect() : " << t.elapsed() / 1e6 << " ms, " << graph.getPendingCount() << " pending, doctor 0 has " << graph.getPatientCount(0) << " patients\n";
+
+        t.reset();
+        graph.merge();
+        std::cout << "merge() : " << t.elapsed() / 1e6 << " ms, doctor 0 has " << graph.getPatients(0).size() << " patients\n";
+    }
+
+    {
+        PrerequisiteGraph courses{};
+        int programming { courses.addCourse("Programming 101") };
+        int structures { courses.addCourse("Data Structures") };
+        int discrete { courses.addCourse("Discrete Math") };
+        int algorithms { courses.addCourse("Algorithms") };
+        int compilers { courses.addCourse("Compilers") };
+
+        courses.addPrerequisite(structures, programming);
+        courses.addPrerequisite(algorithms, structures);
+        courses.addPrerequisite(algorithms, discrete);
+        courses.addPrerequisite(compilers, algorithms);
+
+        std::cout << "Compilers requires Programming 101 : " << std::boolalpha << courses.isRequired(compilers, programming) << '\n';
+        std::cout << "Programming 101 can require Compilers : " << courses.addPrerequisite(programming, compilers) << '\n';
+
+        std::cout << "Order :";
+        for (int course : courses.getTopologicalOrder())
+            std::cout << " [" << courses.getName(course) << ']';
+        std::cout << '\n';
+
+        courses.removePrerequisite(algorithms, structures);
+        std::cout << "Without Data Structures, Compilers requires Programming 101 : " << courses.isRequired(compilers, programming) << std::noboolalpha << '\n';
+    }
+
+    {
+        // 4000 courses, each with up to 3 prerequisites among the courses before it
+        PrerequisiteGraph catalog{};
+        constexpr int courseCount { 4000 };
+        Timer t;
+        for (int course = 0; course < courseCount; ++course)
+        {
+            catalog.addCourse("Course " + std::to_string(course));
+            for (int p = 0; course > 0 && p < 3; ++p)
+                catalog.addPrerequisite(course, static_cast<int>(rng() % static_cast<unsigned int>(course)));
+        }
+        std::cout << "Built " << courseCount << " courses with closure : " << t.elapsed() / 1e6 << " ms\n";
+
+        std::vector<std::pair<int, int>> queries(20000);
+        for (auto& [course, prerequisite] : queries)
+            course = static_cast<int>(rng() % courseCount), prerequisite = static_cast<int>(rng() % courseCount);
+
+        std::vector<std::uint8_t> seen(courseCount);
+        t.reset();
+        int found{};
+        for (auto [course, prerequisite] : queries)
+            found += requiresBySearch(catalog, course, prerequisite, seen);
+        std::cout << "20000 queries, search  : " << t.elapsed() / 1e6 << " ms (" << found << " true)\n";
+
+        t.reset();
+        found = 0;
+        for (auto [course, prerequisite] : queries)
+            found += catalog.isRequired(course, prerequisite);
+        std::cout << "20000 queries, closure : " << t.elapsed() / 1e6 << " ms (" << found << " true)\n";
+    }
+
+    // a big lot : 1000000 cars with random ids, then 1000000 with consecutive ids
+    constexpr int lotSize { 1000000 };
+    constexpr int lookups { 4000000 };
+
+    for (bool consecutive : { false, true })
+    {
+        std::vector<Car> lot{};
+        lot.reserve(lotSize);
+        for (int i = 0; i < lotSize; ++i)
+            lot.emplace_back("Car", consecutive ? 1000 + i : static_cast<int>(rng() >> 1));
+
+        CarIndex index{ lot };
+
+        std::vector<int> wanted(lookups);
+        for (int& id : wanted)
+            id = lot[rng() % lotSize].getId();
+        std::vector<Car*> found(lookups);
+
+        std::cout << lotSize << (consecutive ? " consecutive" : " random") << " ids, " << (index.isDense() ? "dense" : "hash") << " mode, ns per lookup :\n";
+
+        if (!consecutive)
+        {
+            Timer t;
+            long long hits{};
+            for (int i = 0; i < 200; ++i)
+                hits += findCarLinear(lot, wanted[i]) != nullptr;
+            std::cout << "  linear scan       : " << t.elapsed() / 200 << " (" << hits << " found)\n";
+        }
+
+        Timer t;
+        for (int i = 0; i < lookups; ++i)
+            found[i] = index.find(wanted[i]);
+        std::cout << "  find              : " << t.elapsed() / lookups << '\n';
+
+        t.reset();
+        index.findMany(wanted, found);
+        std::cout << "  findMany          : " << t.elapsed() / lookups << '\n';
+
+        bool correct { true };
+        for (int i = 0; i < lookups && correct; ++i)
+            correct = found[i] && found[i]->getId() == wanted[i];
+        std::cout << "  results " << (correct ? "correct" : "WRONG") << '\n';
+    }
+
     return 0;
 }
\ No newline at end of file
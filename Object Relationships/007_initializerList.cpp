@@ -228,31 +228,291 @@
 
     7. Summary : Implementing a constructor that takes a std::initializer_list parameter allows us to use list initialization with our custom classes. We can also use std::initializer_list to implement other functions that need to use an initializer list, such as an assignment operator.
 
+    8. Choosing where the elements live : new int[length] always goes to the global heap. IntArray below instead takes a std::pmr::memory_resource* (defaulting to std::pmr::get_default_resource(), which is the heap) and gets its memory from resource->allocate(). That lets the caller hand it a bump arena, a pool, or any other allocation strategy without IntArray knowing or changing type:
+
+            std::byte buffer[1024];
+            std::pmr::monotonic_buffer_resource arena{ buffer, sizeof(buffer) };
+
+            IntArray scratch{ { 1, 2, 3 }, &arena }; // no heap allocation at all
+
+        - The resource is stored in the object, because the memory has to be given back (deallocate) to the same resource it came from.
+
+    9. Growing IntArray : without resize() or insertBefore(), the only way to add an element is to build a new, longer IntArray and copy everything over. IntArray now keeps a capacity next to its length, like std::vector :
+
+            array.resize(10);                 // keeps the elements, new ones are 0
+            array.insertBefore(42, 0);        // shifts the rest one to the right
+            array.remove(3);                  // shifts the rest one to the left
+            array.append({ 6, 7, 8 });        // or append(std::span<const int>)
+
+        - When the capacity is exceeded it doubles, so appending n elements one at a time copies each element only about twice in total (amortized O(1) per append) instead of n times.
+
+        - The memory still comes from m_resource, and deallocate() is given the capacity, which is the size that was allocated.
+
+        - Copy and move are implemented now instead of deleted. They follow the std::pmr containers :
+
+            = a copy gets the default resource (an arena usually belongs to one scope, the copy may outlive it), pass a resource to IntArray(const IntArray&, resource) to choose
+            = a move steals the buffer together with its resource
+            = copy and move assignment keep the resource of the array assigned to, so a move assignment between different resources copies the elements
+
+    10. Reductions : sum(), min(), max(), find() and count() read the whole array, and work on 8 ints per instruction with AVX2 when the CPU has it (checked once, at runtime, like Specials/simdKernels.cpp), and with a plain loop otherwise. sum() returns a long long, so it doesn't overflow like an int would.
+
 */
 
 #include <algorithm> // for std::copy
 #include <cassert> // for assert()
+#include <chrono>
+#include <cstddef> // for std::byte
 #include <initializer_list> // for std::initializer_list
 #include <iostream>
+#include <memory_resource> // for std::pmr::memory_resource
+#include <span>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+class Timer
+{
+	using Clock = std::chrono::high_resolution_clock;
+	using Nanosecond = std::chrono::duration<double, std::nano>;
+
+	std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+	void reset()
+	{
+		_begin = Clock::now();
+	}
+
+	double elapsed() const
+	{
+		return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+	}
+};
+
+// Whole-array reductions : a plain loop, and an AVX2 version picked at runtime
+namespace reduce
+{
+	namespace scalar
+	{
+		long long sum(const int* data, int length)
+		{
+			long long total{};
+			for (int i{ 0 }; i < length; ++i)
+				total += data[i];
+			return total;
+		}
+
+		int min(const int* data, int length)
+		{
+			return *std::min_element(data, data + length);
+		}
+
+		int max(const int* data, int length)
+		{
+			return *std::max_element(data, data + length);
+		}
+
+		int find(const int* data, int length, int value)
+		{
+			for (int i{ 0 }; i < length; ++i)
+				if (data[i] == value)
+					return i;
+			return -1;
+		}
+
+		int count(const int* data, int length, int value)
+		{
+			int total{};
+			for (int i{ 0 }; i < length; ++i)
+				total += data[i] == value;
+			return total;
+		}
+	}
+
+#if SIMD_X86
+	namespace avx2
+	{
+		__attribute__((target("avx2"))) long long sum(const int* data, int length)
+		{
+			// widen to 64 bit lanes before adding, 4 + 4 at a time
+			__m256i low{ _mm256_setzero_si256() };
+			__m256i high{ _mm256_setzero_si256() };
+			int i{ 0 };
+			for (; i + 8 <= length; i += 8)
+			{
+				__m256i x{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)) };
+				low = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+				high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+			}
+
+			alignas(32) long long lanes[4];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(low, high));
+			return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar::sum(data + i, length - i);
+		}
+
+		__attribute__((target("avx2"))) int min(const int* data, int length)
+		{
+			if (length < 8)
+				return scalar::min(data, length);
+
+			__m256i best{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)) };
+			int i{ 8 };
+			for (; i + 8 <= length; i += 8)
+				best = _mm256_min_epi32(best, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+
+			alignas(32) int lanes[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+			int result{ scalar::min(lanes, 8) };
+			return i < length ? std::min(result, scalar::min(data + i, length - i)) : result;
+		}
+
+		__attribute__((target("avx2"))) int max(const int* data, int length)
+		{
+			if (length < 8)
+				return scalar::max(data, length);
+
+			__m256i best{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)) };
+			int i{ 8 };
+			for (; i + 8 <= length; i += 8)
+				best = _mm256_max_epi32(best, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+
+			alignas(32) int lanes[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+			int result{ scalar::max(lanes, 8) };
+			return i < length ? std::max(result, scalar::max(data + i, length - i)) : result;
+		}
+
+		__attribute__((target("avx2"))) int find(const int* data, int length, int value)
+		{
+			__m256i wanted{ _mm256_set1_epi32(value) };
+			int i{ 0 };
+			for (; i + 8 <= length; i += 8)
+			{
+				__m256i equal{ _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), wanted) };
+				int mask{ _mm256_movemask_ps(_mm256_castsi256_ps(equal)) }; // one bit per lane
+				if (mask)
+					return i + __builtin_ctz(static_cast<unsigned>(mask));
+			}
+
+			int rest{ scalar::find(data + i, length - i, value) };
+			return rest < 0 ? -1 : i + rest;
+		}
+
+		__attribute__((target("avx2"))) int count(const int* data, int length, int value)
+		{
+			// a lane that matches is all ones, which is -1, so subtracting it counts it
+			__m256i wanted{ _mm256_set1_epi32(value) };
+			__m256i counts{ _mm256_setzero_si256() };
+			int i{ 0 };
+			for (; i + 8 <= length; i += 8)
+				counts = _mm256_sub_epi32(counts, _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), wanted));
+
+			alignas(32) int lanes[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), counts);
+			int total{ scalar::count(data + i, length - i, value) };
+			for (int lane : lanes)
+				total += lane;
+			return total;
+		}
+	}
+#endif
+
+	bool hasAvx2()
+	{
+#if SIMD_X86
+		static const bool supported{ __builtin_cpu_supports("avx2") != 0 };
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+#if SIMD_X86
+#define REDUCE_DISPATCH(call) return hasAvx2() ? avx2::call : scalar::call
+#else
+#define REDUCE_DISPATCH(call) return scalar::call
+#endif
+
+	long long sum(const int* data, int length) { REDUCE_DISPATCH(sum(data, length)); }
+	int min(const int* data, int length) { REDUCE_DISPATCH(min(data, length)); }
+	int max(const int* data, int length) { REDUCE_DISPATCH(max(data, length)); }
+	int find(const int* data, int length, int value) { REDUCE_DISPATCH(find(data, length, value)); }
+	int count(const int* data, int length, int value) { REDUCE_DISPATCH(count(data, length, value)); }
+
+#undef REDUCE_DISPATCH
+}
 
 class IntArray
 {
 private:
 	int m_length {};
+	int m_capacity {};
 	int* m_data{};
+	std::pmr::memory_resource* m_resource{ std::pmr::get_default_resource() }; // where m_data came from
+
+	static int* allocate(std::pmr::memory_resource* resource, int capacity)
+	{
+		if (capacity == 0)
+			return nullptr;
+		return static_cast<int*>(resource->allocate(sizeof(int) * static_cast<std::size_t>(capacity), alignof(int)));
+	}
+
+	void deallocate()
+	{
+		if (m_data)
+			m_resource->deallocate(m_data, sizeof(int) * static_cast<std::size_t>(m_capacity), alignof(int));
+	}
+
+	// Move the elements to a bigger buffer, at least doubling, so n appends copy O(n) elements in total
+	void grow(int minCapacity)
+	{
+		int newCapacity{ std::max({ minCapacity, m_capacity * 2, 4 }) };
+		int* data{ allocate(m_resource, newCapacity) };
+		std::copy_n(m_data, m_length, data);
+
+		deallocate();
+		m_data = data;
+		m_capacity = newCapacity;
+	}
+
+	// Replace the elements with values, in our own resource
+	void assign(std::span<const int> values)
+	{
+		int length{ static_cast<int>(values.size()) };
+		if (length > m_capacity)
+		{
+			int* data{ allocate(m_resource, length) };
+			std::copy(values.begin(), values.end(), data);
+			deallocate();
+			m_data = data;
+			m_capacity = length;
+		}
+		else
+		{
+			std::copy(values.begin(), values.end(), m_data);
+		}
+		m_length = length;
+	}
 
 public:
 	IntArray() = default;
 
-	IntArray(int length)
+	IntArray(int length, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
 		: m_length{ length }
-		, m_data{ new int[static_cast<std::size_t>(length)] {} }
+		, m_capacity{ length }
+		, m_data{ allocate(resource, length) }
+		, m_resource{ resource }
 	{
-
+		std::fill_n(m_data, m_length, 0);
 	}
 
-	IntArray(std::initializer_list<int> list) // allow IntArray to be initialized via list initialization
-		: IntArray(static_cast<int>(list.size())) // use delegating constructor to set up initial array
+	IntArray(std::initializer_list<int> list, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) // allow IntArray to be initialized via list initialization
+		: IntArray(static_cast<int>(list.size()), resource) // use delegating constructor to set up initial array
 	{
 		// Now initialize our array from the list
 		std::copy(list.begin(), list.end(), m_data);
@@ -260,12 +520,128 @@ public:
 
 	~IntArray()
 	{
-		delete[] m_data;
+		deallocate();
 		// we don't need to set m_data to null or m_length to 0 here, since the object will be destroyed immediately after this function anyway
 	}
 
-	IntArray(const IntArray&) = delete; // to avoid shallow copies
-	IntArray& operator=(const IntArray& list) = delete; // to avoid shallow copies
+	// deep copy, into the default resource unless told otherwise (see note 9)
+	IntArray(const IntArray& copy, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: IntArray(copy.m_length, resource)
+	{
+		std::copy_n(copy.m_data, copy.m_length, m_data);
+	}
+
+	IntArray(IntArray&& copy) noexcept
+		: m_length{ copy.m_length }
+		, m_capacity{ copy.m_capacity }
+		, m_data{ copy.m_data }
+		, m_resource{ copy.m_resource }
+	{
+		copy.m_length = 0;
+		copy.m_capacity = 0;
+		copy.m_data = nullptr;
+	}
+
+	IntArray& operator=(const IntArray& copy)
+	{
+		if (this != &copy)
+			assign({ copy.m_data, static_cast<std::size_t>(copy.m_length) });
+
+		return *this;
+	}
+
+	IntArray& operator=(IntArray&& copy)
+	{
+		if (this == &copy)
+			return *this;
+
+		// the buffer can only change hands if it goes back to the same resource
+		if (*m_resource != *copy.m_resource)
+		{
+			assign({ copy.m_data, static_cast<std::size_t>(copy.m_length) });
+			return *this;
+		}
+
+		deallocate();
+		m_length = copy.m_length;
+		m_capacity = copy.m_capacity;
+		m_data = copy.m_data;
+		copy.m_length = 0;
+		copy.m_capacity = 0;
+		copy.m_data = nullptr;
+
+		return *this;
+	}
+
+	IntArray& operator=(std::initializer_list<int> list)
+	{
+		assign({ list.begin(), list.size() });
+
+		return *this;
+	}
+
+	void reserve(int capacity)
+	{
+		if (capacity > m_capacity)
+			grow(capacity);
+	}
+
+	// Keep the first min(length, newLength) elements, new ones are 0
+	void resize(int newLength)
+	{
+		assert(newLength >= 0);
+		if (newLength > m_capacity)
+			grow(newLength);
+		if (newLength > m_length)
+			std::fill(m_data + m_length, m_data + newLength, 0);
+
+		m_length = newLength;
+	}
+
+	void insertBefore(int value, int index)
+	{
+		assert(index >= 0 && index <= m_length);
+		if (m_length == m_capacity)
+			grow(m_length + 1);
+
+		std::copy_backward(m_data + index, m_data + m_length, m_data + m_length + 1);
+		m_data[index] = value;
+		++m_length;
+	}
+
+	void remove(int index)
+	{
+		assert(index >= 0 && index < m_length);
+		std::copy(m_data + index + 1, m_data + m_length, m_data + index);
+		--m_length;
+	}
+
+	void append(std::span<const int> values)
+	{
+		int count{ static_cast<int>(values.size()) };
+		if (m_length + count > m_capacity)
+		{
+			// values may be our own elements, so read them before the old buffer is freed
+			int newCapacity{ std::max(m_length + count, m_capacity * 2) };
+			int* data{ allocate(m_resource, newCapacity) };
+			std::copy_n(m_data, m_length, data);
+			std::copy(values.begin(), values.end(), data + m_length);
+
+			deallocate();
+			m_data = data;
+			m_capacity = newCapacity;
+		}
+		else
+		{
+			std::copy(values.begin(), values.end(), m_data + m_length);
+		}
+		m_length += count;
+	}
+
+	void append(std::initializer_list<int> list)
+	{
+		append(std::span<const int>{ list.begin(), list.size() });
+	}
 
 	int& operator[](int index)
 	{
@@ -273,14 +649,113 @@ public:
 		return m_data[index];
 	}
 
+	const int& operator[](int index) const
+	{
+		assert(index >= 0 && index < m_length);
+		return m_data[index];
+	}
+
 	int getLength() const { return m_length; }
+	int getCapacity() const { return m_capacity; }
+
+	long long sum() const { return reduce::sum(m_data, m_length); }
+
+	int min() const
+	{
+		assert(m_length > 0);
+		return reduce::min(m_data, m_length);
+	}
+
+	int max() const
+	{
+		assert(m_length > 0);
+		return reduce::max(m_data, m_length);
+	}
+
+	// Index of the first element equal to value, or -1
+	int find(int value) const { return reduce::find(m_data, m_length, value); }
+	int count(int value) const { return reduce::count(m_data, m_length, value); }
 };
 
-int main()
+void print(const IntArray& array)
 {
-	IntArray array{ 5, 4, 3, 2, 1 }; // initializer list
 	for (int count{ 0 }; count < array.getLength(); ++count)
 		std::cout << array[count] << ' ';
+	std::cout << '\n';
+}
+
+int main()
+{
+	IntArray array{ 5, 4, 3, 2, 1 }; // initializer list
+	print(array);
+
+	// the same class, but its memory comes from a buffer on the stack
+	std::byte buffer[1024];
+	std::pmr::monotonic_buffer_resource arena{ buffer, sizeof(buffer) };
+
+	IntArray scratch{ { 1, 2, 3 }, &arena };
+	print(scratch);
+
+	// editing in place
+	array.insertBefore(42, 0);
+	array.remove(3);
+	array.append({ 6, 7, 8 });
+	array.append(std::span<const int>{ &array[0], 2 }); // from itself
+	array.resize(12);
+	print(array);
+
+	IntArray copy{ array };
+	copy[0] = -1;
+	scratch = std::move(copy); // different resources : the elements are copied into the arena
+	array = { 1, 3, 5, 7, 9, 11 };
+	print(scratch);
+	print(array);
+
+	// growing one element at a time : rebuild a new array each time vs append
+	constexpr int growCount{ 20000 };
+	Timer t;
+	{
+		IntArray rebuilt{};
+		for (int i{ 0 }; i < growCount; ++i)
+		{
+			IntArray longer(rebuilt.getLength() + 1);
+			for (int j{ 0 }; j < rebuilt.getLength(); ++j)
+				longer[j] = rebuilt[j];
+			longer[i] = i;
+			rebuilt = std::move(longer);
+		}
+	}
+	std::cout << growCount << " appends by rebuilding : " << t.elapsed() / 1e6 << " ms\n";
+
+	t.reset();
+	{
+		IntArray grown{};
+		for (int i{ 0 }; i < growCount; ++i)
+			grown.append({ i });
+	}
+	std::cout << growCount << " appends with append() : " << t.elapsed() / 1e6 << " ms\n";
+
+	// reductions over 16M ints, plain loops vs the dispatched kernels
+	constexpr int length{ 1 << 24 };
+	IntArray big(length);
+	for (int i{ 0 }; i < length; ++i)
+		big[i] = static_cast<int>((i * 2654435761u) % 1000003) - 500000;
+	const int* data{ &big[0] };
+
+	t.reset();
+	long long sum{ reduce::scalar::sum(data, length) };
+	int low{ reduce::scalar::min(data, length) };
+	int high{ reduce::scalar::max(data, length) };
+	int where{ reduce::scalar::find(data, length, 123456) };
+	int hits{ reduce::scalar::count(data, length, 0) };
+	double scalarNs{ t.elapsed() };
+
+	t.reset();
+	bool same{ big.sum() == sum && big.min() == low && big.max() == high && big.find(123456) == where && big.count(0) == hits };
+	double simdNs{ t.elapsed() };
+
+	std::cout << "sum/min/max/find/count : plain loops " << scalarNs / 1e6 << " ms, " << (reduce::hasAvx2() ? "avx2 " : "fallback ")
+	          << simdNs / 1e6 << " ms" << (same ? "" : " (RESULTS DIFFER)") << '\n';
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -170,9 +170,47 @@
 
         It is often possible to define overloaded operators by calling other overloaded operators. You should do so if and when doing so produces simpler code. In cases where the implementation is trivial (e.g. a single line) it may or may not be worth doing this.
 
+    8. Money that never wraps around : paisa and Cents hold an int, so 2147483647 paisa + 1 paisa silently becomes -2147483648 (and strictly speaking, signed overflow is undefined behavior). Money below fixes both problems :
+
+        - It holds a 64 bit integer count of the smallest unit, and the number of decimals is a template parameter : Money<2> counts cents, Money<4> ten-thousandths. Integers, not double, because 0.1 + 0.2 != 0.3 in binary floating point.
+
+        - What happens on overflow is a template parameter too :
+
+            OverflowPolicy::check      throws std::overflow_error
+            OverflowPolicy::saturate   stops at the largest (or smallest) amount
+
+        - The operators are still friends, but each one checks its result with __builtin_add_overflow / __builtin_sub_overflow / __builtin_mul_overflow (GCC and Clang), which compute the operation and tell whether it fit.
+
+    9. Ledger : a column store of amounts. Instead of a vector of { account, amount } structs, the accounts and the amounts are two separate arrays, so summing the amounts reads only the amounts (8 bytes per entry instead of 16), and they are contiguous for SIMD.
+
+        - sum() adds 4 amounts per instruction with AVX2 (picked at runtime, like the IntArray reductions in Object Relationships/007_initializerList.cpp). AVX2 has no overflow flag, so each lane checks the sign of its result : adding two numbers of the same sign and getting the other sign means it wrapped.
+
+        - A lane that wrapped does not mean the total doesn't fit (a lane of big deposits and a lane of big withdrawals can cancel out), so in that case the sum is done again exactly, with a 128 bit accumulator. Either way the total is exact, and the overflow policy decides what happens when it doesn't fit in Money.
+
+        - min() and max() can't overflow, AVX2 does them 4 at a time with compare and blend.
+
+        - Over hundreds of millions of amounts the loop waits on memory more than on additions, so summarize() computes the sum, the min and the max in the same pass.
+
 
 */
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
 class paisa
 {
     private:
@@ -215,6 +253,391 @@ paisa operator+(const int i , const paisa &paisa)
     return i + paisa._kitna;
 }
 
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+enum class OverflowPolicy
+{
+    check,
+    saturate,
+};
+
+template <int Decimals, OverflowPolicy Policy = OverflowPolicy::check>
+class Money
+{
+    static_assert(Decimals >= 0 && Decimals <= 18, "10^Decimals has to fit in 64 bits");
+
+    private:
+
+    std::int64_t _units {}; // the amount times 10^Decimals
+
+    static constexpr std::int64_t largest { std::numeric_limits<std::int64_t>::max() };
+    static constexpr std::int64_t smallest { std::numeric_limits<std::int64_t>::min() };
+
+    static Money overflowed(bool positive, const char *what)
+    {
+        if constexpr (Policy == OverflowPolicy::check)
+            throw std::overflow_error{what};
+        else
+            return Money{positive ? largest : smallest};
+    }
+
+    public:
+
+    static constexpr std::int64_t scale { []{ std::int64_t s { 1 }; for (int i = 0; i < Decimals; ++i) s *= 10; return s; }() };
+
+    constexpr Money() = default;
+
+    // Like paisa(int kitna) : the amount in the smallest unit
+    explicit constexpr Money(std::int64_t units) : _units(units){}
+
+    // An exact total (from a sum of many amounts) that may not fit
+    static Money fromWide(__int128 units)
+    {
+        if (units > largest || units < smallest)
+            return overflowed(units > 0, "Money : the amount doesn't fit in 64 bits");
+        return Money{static_cast<std::int64_t>(units)};
+    }
+
+    std::int64_t getUnits() const
+    {
+        return _units;
+    }
+
+    friend Money operator+(Money first , Money second)
+    {
+        std::int64_t result {};
+        if (__builtin_add_overflow(first._units, second._units, &result))
+            return overflowed(second._units > 0, "Money : overflow in +");
+        return Money{result};
+    }
+
+    friend Money operator-(Money first , Money second)
+    {
+        std::int64_t result {};
+        if (__builtin_sub_overflow(first._units, second._units, &result))
+            return overflowed(first._units >= 0, "Money : overflow in -");
+        return Money{result};
+    }
+
+    friend Money operator-(Money money)
+    {
+        return Money{} - money;
+    }
+
+    // A quantity of items at this price
+    friend Money operator*(Money money , std::int64_t count)
+    {
+        std::int64_t result {};
+        if (__builtin_mul_overflow(money._units, count, &result))
+            return overflowed((money._units > 0) == (count > 0), "Money : overflow in *");
+        return Money{result};
+    }
+
+    friend Money operator*(std::int64_t count , Money money)
+    {
+        return money * count;
+    }
+
+    // Rounds toward zero, like int division
+    friend Money operator/(Money money , std::int64_t count)
+    {
+        if (count == 0)
+            throw std::domain_error{"Money : division by zero"};
+        if (money._units == smallest && count == -1)
+            return overflowed(true, "Money : overflow in /");
+        return Money{money._units / count};
+    }
+
+    Money& operator+=(Money other)
+    {
+        return *this = *this + other;
+    }
+
+    friend auto operator<=>(Money, Money) = default;
+
+    friend std::ostream& operator<<(std::ostream &out , Money money)
+    {
+        // through unsigned, so that the smallest amount can be negated
+        std::uint64_t units { money._units < 0 ? 0 - static_cast<std::uint64_t>(money._units) : static_cast<std::uint64_t>(money._units) };
+        if (money._units < 0)
+            out << '-';
+        out << units / scale;
+
+        if constexpr (Decimals > 0)
+        {
+            std::string fraction { std::to_string(units % scale) };
+            out << '.' << std::string(Decimals - fraction.size(), '0') << fraction;
+        }
+        return out;
+    }
+};
+
+// Whole-column kernels on the amounts, a plain loop and an AVX2 version picked at runtime
+namespace ledgerKernels
+{
+    struct Summary
+    {
+        __int128 total {};
+        std::int64_t min {};
+        std::int64_t max {};
+    };
+
+    namespace scalar
+    {
+        // Exact : a 128 bit accumulator can't overflow on fewer than 2^63 amounts
+        __int128 sum(const std::int64_t *amounts , std::size_t count)
+        {
+            __int128 total {};
+            for (std::size_t i = 0; i < count; ++i)
+                total += amounts[i];
+            return total;
+        }
+
+        std::int64_t min(const std::int64_t *amounts , std::size_t count)
+        {
+            return *std::min_element(amounts, amounts + count);
+        }
+
+        std::int64_t max(const std::int64_t *amounts , std::size_t count)
+        {
+            return *std::max_element(amounts, amounts + count);
+        }
+
+        Summary summarize(const std::int64_t *amounts , std::size_t count)
+        {
+            Summary summary { 0, amounts[0], amounts[0] };
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                summary.total += amounts[i];
+                summary.min = std::min(summary.min, amounts[i]);
+                summary.max = std::max(summary.max, amounts[i]);
+            }
+            return summary;
+        }
+    }
+
+#if SIMD_X86
+#pragma GCC push_options
+#pragma GCC target("avx2")
+    namespace avx2
+    {
+        __int128 sum(const std::int64_t *amounts , std::size_t count)
+        {
+            __m256i total { _mm256_setzero_si256() };
+            __m256i wrapped { _mm256_setzero_si256() };
+            std::size_t i { 0 };
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256i x { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts + i)) };
+                __m256i next { _mm256_add_epi64(total, x) };
+
+                // the sign bit of (total ^ next) & (x ^ next) is set when the lane wrapped
+                wrapped = _mm256_or_si256(wrapped, _mm256_and_si256(_mm256_xor_si256(total, next), _mm256_xor_si256(x, next)));
+                total = next;
+            }
+
+            if (_mm256_movemask_pd(_mm256_castsi256_pd(wrapped)) != 0)
+                return scalar::sum(amounts, count); // a lane wrapped, start again exactly
+
+            alignas(32) std::int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+            return static_cast<__int128>(lanes[0]) + lanes[1] + lanes[2] + lanes[3] + scalar::sum(amounts + i, count - i);
+        }
+
+        std::int64_t min(const std::int64_t *amounts , std::size_t count)
+        {
+            if (count < 4)
+                return scalar::min(amounts, count);
+
+            __m256i best { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts)) };
+            std::size_t i { 4 };
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256i x { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts + i)) };
+                best = _mm256_blendv_epi8(best, x, _mm256_cmpgt_epi64(best, x));
+            }
+
+            alignas(32) std::int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), best);
+            std::int64_t result { scalar::min(lanes, 4) };
+            return i < count ? std::min(result, scalar::min(amounts + i, count - i)) : result;
+        }
+
+        std::int64_t max(const std::int64_t *amounts , std::size_t count)
+        {
+            if (count < 4)
+                return scalar::max(amounts, count);
+
+            __m256i best { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts)) };
+            std::size_t i { 4 };
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256i x { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts + i)) };
+                best = _mm256_blendv_epi8(best, x, _mm256_cmpgt_epi64(x, best));
+            }
+
+            alignas(32) std::int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), best);
+            std::int64_t result { scalar::max(lanes, 4) };
+            return i < count ? std::max(result, scalar::max(amounts + i, count - i)) : result;
+        }
+
+        // sum, min and max in one pass over memory
+        Summary summarize(const std::int64_t *amounts , std::size_t count)
+        {
+            if (count < 4)
+                return scalar::summarize(amounts, count);
+
+            __m256i total { _mm256_setzero_si256() };
+            __m256i wrapped { _mm256_setzero_si256() };
+            __m256i low { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts)) };
+            __m256i high { low };
+            std::size_t i { 0 };
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256i x { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts + i)) };
+                __m256i next { _mm256_add_epi64(total, x) };
+                wrapped = _mm256_or_si256(wrapped, _mm256_and_si256(_mm256_xor_si256(total, next), _mm256_xor_si256(x, next)));
+                total = next;
+                low = _mm256_blendv_epi8(low, x, _mm256_cmpgt_epi64(low, x));
+                high = _mm256_blendv_epi8(high, x, _mm256_cmpgt_epi64(x, high));
+            }
+
+            alignas(32) std::int64_t lanes[4];
+            Summary summary {};
+            if (_mm256_movemask_pd(_mm256_castsi256_pd(wrapped)) != 0)
+            {
+                summary.total = scalar::sum(amounts, count);
+            }
+            else
+            {
+                _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+                summary.total = static_cast<__int128>(lanes[0]) + lanes[1] + lanes[2] + lanes[3] + scalar::sum(amounts + i, count - i);
+            }
+
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), low);
+            summary.min = scalar::min(lanes, 4);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), high);
+            summary.max = scalar::max(lanes, 4);
+            if (i < count)
+            {
+                summary.min = std::min(summary.min, scalar::min(amounts + i, count - i));
+                summary.max = std::max(summary.max, scalar::max(amounts + i, count - i));
+            }
+            return summary;
+        }
+    }
+#pragma GCC pop_options
+#endif
+
+    bool hasAvx2()
+    {
+#if SIMD_X86
+        static const bool supported { __builtin_cpu_supports("avx2") != 0 };
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+#if SIMD_X86
+#define LEDGER_DISPATCH(call) return hasAvx2() ? avx2::call : scalar::call
+#else
+#define LEDGER_DISPATCH(call) return scalar::call
+#endif
+
+    __int128 sum(const std::int64_t *amounts , std::size_t count) { LEDGER_DISPATCH(sum(amounts, count)); }
+    std::int64_t min(const std::int64_t *amounts , std::size_t count) { LEDGER_DISPATCH(min(amounts, count)); }
+    std::int64_t max(const std::int64_t *amounts , std::size_t count) { LEDGER_DISPATCH(max(amounts, count)); }
+    Summary summarize(const std::int64_t *amounts , std::size_t count) { LEDGER_DISPATCH(summarize(amounts, count)); }
+
+#undef LEDGER_DISPATCH
+}
+
+template <typename MoneyType>
+class Ledger
+{
+    private:
+
+    // one array per column
+    std::vector<int> _accounts {};
+    std::vector<std::int64_t> _amounts {};
+
+    public:
+
+    void reserve(std::size_t count)
+    {
+        _accounts.reserve(count);
+        _amounts.reserve(count);
+    }
+
+    void add(int account , MoneyType amount)
+    {
+        _accounts.push_back(account);
+        _amounts.push_back(amount.getUnits());
+    }
+
+    std::size_t getLength() const
+    {
+        return _amounts.size();
+    }
+
+    int getAccount(std::size_t index) const
+    {
+        return _accounts[index];
+    }
+
+    MoneyType getAmount(std::size_t index) const
+    {
+        return MoneyType{_amounts[index]};
+    }
+
+    // Exact, then checked or saturated by MoneyType's policy
+    MoneyType sum() const
+    {
+        return MoneyType::fromWide(ledgerKernels::sum(_amounts.data(), _amounts.size()));
+    }
+
+    MoneyType min() const
+    {
+        assert(!_amounts.empty());
+        return MoneyType{ledgerKernels::min(_amounts.data(), _amounts.size())};
+    }
+
+    MoneyType max() const
+    {
+        assert(!_amounts.empty());
+        return MoneyType{ledgerKernels::max(_amounts.data(), _amounts.size())};
+    }
+
+    // sum(), min() and max() in a single pass over the amounts
+    void summarize(MoneyType &total , MoneyType &min , MoneyType &max) const
+    {
+        assert(!_amounts.empty());
+        ledgerKernels::Summary summary { ledgerKernels::summarize(_amounts.data(), _amounts.size()) };
+        total = MoneyType::fromWide(summary.total);
+        min = MoneyType{summary.min};
+        max = MoneyType{summary.max};
+    }
+};
+
 int main()
 {
     paisa p1{1};
@@ -232,6 +655,87 @@ int main()
     std::cout<<"Paisa 4 : "<<p4.getPaisa()<<std::endl;
     std::cout<<"Paisa 5 : "<<p5.getPaisa()<<std::endl;
 
+    using Rupees = Money<2>;
+    using SaturatingRupees = Money<2, OverflowPolicy::saturate>;
+
+    Rupees price{1999};
+    std::cout<<"3 x "<<price<<" = "<<price * 3<<", "<<-price<<" / 2 = "<<-price / 2<<std::endl;
+
+    try
+    {
+        Rupees big{std::numeric_limits<std::int64_t>::max()};
+        std::cout<<big + Rupees{1}<<std::endl;
+    }
+    catch (const std::overflow_error &error)
+    {
+        std::cout<<"Caught: "<<error.what()<<std::endl;
+    }
+    std::cout<<"saturating : "<<SaturatingRupees{std::numeric_limits<std::int64_t>::max()} + SaturatingRupees{1}<<std::endl;
+
+    // 16M ledger entries, amounts between -1000.00 and +1000.00
+    constexpr std::size_t entries { 1 << 24 };
+    Ledger<Rupees> ledger{};
+    ledger.reserve(entries);
+    std::uint64_t seed { 42 };
+    for (std::size_t i = 0; i < entries; ++i)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        ledger.add(static_cast<int>(i % 1000), Rupees{static_cast<std::int64_t>(seed >> 33) % 200001 - 100000});
+    }
+
+    // the same amounts in a vector of { account, amount } structs, summed with the checked operator+
+    struct Entry
+    {
+        int account {};
+        Rupees amount {};
+    };
+    std::vector<Entry> rows{};
+    rows.reserve(entries);
+    for (std::size_t i = 0; i < ledger.getLength(); ++i)
+        rows.push_back(Entry{ledger.getAccount(i), ledger.getAmount(i)});
+
+    Timer t;
+    Rupees rowTotal{};
+    Rupees rowMin{rows[0].amount};
+    Rupees rowMax{rows[0].amount};
+    for (const Entry &row : rows)
+    {
+        rowTotal += row.amount;
+        rowMin = std::min(rowMin, row.amount);
+        rowMax = std::max(rowMax, row.amount);
+    }
+    double rowNs { t.elapsed() };
+
+    t.reset();
+    Rupees total{};
+    Rupees low{};
+    Rupees high{};
+    ledger.summarize(total, low, high);
+    double ledgerNs { t.elapsed() };
+
+    std::cout<<"sum "<<total<<", min "<<low<<", max "<<high<<std::endl;
+    std::cout<<entries<<" amounts, sum + min + max : rows with operator+ "<<rowNs / 1e6<<" ms, Ledger ("<<(ledgerKernels::hasAvx2() ? "avx2" : "scalar")<<") "
+             <<ledgerNs / 1e6<<" ms"<<(total == rowTotal && low == rowMin && high == rowMax && total == ledger.sum() && low == ledger.min() && high == ledger.max() ? "" : " (RESULTS DIFFER)")<<std::endl;
+
+    // a lane wraps, but the total fits : the exact sum is used
+    Ledger<Rupees> swings{};
+    for (int i = 0; i < 8; ++i)
+        swings.add(i, Rupees{i % 2 == 0 ? std::numeric_limits<std::int64_t>::max() / 2 + 1 : -(std::numeric_limits<std::int64_t>::max() / 2)});
+    std::cout<<"swings sum : "<<swings.sum()<<std::endl;
+
+    // the total itself doesn't fit
+    Ledger<Rupees> deposits{};
+    for (int i = 0; i < 3; ++i)
+        deposits.add(i, Rupees{std::numeric_limits<std::int64_t>::max() / 2});
+    try
+    {
+        std::cout<<deposits.sum()<<std::endl;
+    }
+    catch (const std::overflow_error &error)
+    {
+        std::cout<<"Caught: "<<error.what()<<std::endl;
+    }
+
 
     return 0;
 }
\ No newline at end of file
@@ -68,8 +68,381 @@
 
         - Operator() is also often overloaded to create functors. Although simple functors (such as the example above) are fairly easily understood, functors are typically used in more advanced programming topics, and deserve their own lesson.
 
+    6. A Matrix that is fast enough for a geometry pipeline : transforming millions of points with m(row, col) means 16 asserted calls per point. Below, the Matrix from note 2 gets whole-matrix operations that work on the array directly :
+
+            a * b               multiply
+            m.transposed()
+            m.inverse()         throws std::domain_error if the matrix is singular
+            m * v               transform one Vec4
+            transformPoints(m, in, out)     transform a whole span of Vec4 in one call
+
+        - The storage is alignas(32), so a row of 4 doubles is exactly one AVX register (256 bits), and Vec4 is aligned the same way.
+
+        - Each operation has a plain C++ kernel and an AVX kernel. The AVX one is picked at runtime when the CPU has it (__builtin_cpu_supports), so the program still runs on older CPUs, and no -mavx is needed (see Specials/simdKernels.cpp). Both kernels do the additions in the same order, and fp-contract is off around them so neither gets fused multiply-adds (e.g. with -march=haswell), so they give the same results bit for bit.
+
+        - With AVX a row of the product is 4 broadcasts, 4 multiplies and 3 adds, and a transformed point is the same with the columns of the matrix. transformPoints transposes the matrix once for the whole batch, not once per point.
+
+        - The inverse uses the cofactors of the 2x2 sub-matrices (the same formula GLM uses), which is naturally 4 lanes wide : no pivoting and no branches, one division for the determinant.
+
+        - operator() keeps its asserts : it is still the right way to read or write a single element.
+
 */
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+struct alignas(32) Vec4
+{
+    double x {};
+    double y {};
+    double z {};
+    double w {};
+};
+
+// The kernels work on 16 doubles, row by row.
+// No fused multiply-add : with -march=haswell the compiler could turn a * b + c into one fma in one kernel and not the other, and the results would differ in the last bits
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#ifdef __clang__
+#pragma clang fp contract(off)
+#endif
+namespace matrixKernels
+{
+    namespace scalar
+    {
+        void multiply(const double* a, const double* b, double* out)
+        {
+            for (int i = 0; i < 4; ++i)
+                for (int j = 0; j < 4; ++j)
+                    out[i * 4 + j] = ((a[i * 4] * b[j] + a[i * 4 + 1] * b[4 + j]) + a[i * 4 + 2] * b[8 + j]) + a[i * 4 + 3] * b[12 + j];
+        }
+
+        void transpose(const double* a, double* out)
+        {
+            for (int i = 0; i < 4; ++i)
+                for (int j = 0; j < 4; ++j)
+                    out[j * 4 + i] = a[i * 4 + j];
+        }
+
+        void transform(const double* m, const Vec4* in, Vec4* out, std::size_t count)
+        {
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                const Vec4 v { in[p] };
+                double r[4];
+                for (int i = 0; i < 4; ++i)
+                    r[i] = ((m[i * 4] * v.x + m[i * 4 + 1] * v.y) + m[i * 4 + 2] * v.z) + m[i * 4 + 3] * v.w;
+                out[p] = Vec4 { r[0], r[1], r[2], r[3] };
+            }
+        }
+
+        // Returns the determinant, out is only written when it is not 0
+        double inverse(const double* a, double* out)
+        {
+            auto m = [a](int r, int c) { return a[r * 4 + c]; };
+
+            // the 2x2 determinants of the lower rows, 4 lanes at a time (lanes 0 and 1 are the same)
+            double fac[6][4] {};
+            const int cols[6][2] { { 2, 3 }, { 1, 3 }, { 1, 2 }, { 0, 3 }, { 0, 2 }, { 0, 1 } };
+            for (int f = 0; f < 6; ++f)
+            {
+                int c0 { cols[f][0] };
+                int c1 { cols[f][1] };
+                fac[f][0] = fac[f][1] = m(2, c0) * m(3, c1) - m(3, c0) * m(2, c1);
+                fac[f][2] = m(1, c0) * m(3, c1) - m(3, c0) * m(1, c1);
+                fac[f][3] = m(1, c0) * m(2, c1) - m(2, c0) * m(1, c1);
+            }
+
+            double vec[4][4] {};
+            for (int c = 0; c < 4; ++c)
+            {
+                vec[c][0] = m(1, c);
+                vec[c][1] = vec[c][2] = vec[c][3] = m(0, c);
+            }
+
+            double inv[4][4] {};
+            for (int l = 0; l < 4; ++l)
+            {
+                double signA { l % 2 == 0 ? 1.0 : -1.0 };
+                inv[0][l] = ((vec[1][l] * fac[0][l] - vec[2][l] * fac[1][l]) + vec[3][l] * fac[2][l]) * signA;
+                inv[1][l] = ((vec[0][l] * fac[0][l] - vec[2][l] * fac[3][l]) + vec[3][l] * fac[4][l]) * -signA;
+                inv[2][l] = ((vec[0][l] * fac[1][l] - vec[1][l] * fac[3][l]) + vec[3][l] * fac[5][l]) * signA;
+                inv[3][l] = ((vec[0][l] * fac[2][l] - vec[1][l] * fac[4][l]) + vec[2][l] * fac[5][l]) * -signA;
+            }
+
+            double determinant { (m(0, 0) * inv[0][0] + m(0, 1) * inv[1][0]) + (m(0, 2) * inv[2][0] + m(0, 3) * inv[3][0]) };
+            if (determinant == 0.0)
+                return determinant;
+
+            double oneOverDeterminant { 1.0 / determinant };
+            for (int i = 0; i < 4; ++i)
+                for (int l = 0; l < 4; ++l)
+                    out[i * 4 + l] = inv[i][l] * oneOverDeterminant;
+
+            return determinant;
+        }
+    }
+
+#if SIMD_X86
+#pragma GCC push_options
+#pragma GCC target("avx")
+    namespace avx
+    {
+        // c0..c3 are the rows of a, transposed
+        void transposeRows(__m256d r0, __m256d r1, __m256d r2, __m256d r3, __m256d& c0, __m256d& c1, __m256d& c2, __m256d& c3)
+        {
+            __m256d t0 { _mm256_unpacklo_pd(r0, r1) };  // r00 r10 r02 r12
+            __m256d t1 { _mm256_unpackhi_pd(r0, r1) };  // r01 r11 r03 r13
+            __m256d t2 { _mm256_unpacklo_pd(r2, r3) };  // r20 r30 r22 r32
+            __m256d t3 { _mm256_unpackhi_pd(r2, r3) };  // r21 r31 r23 r33
+
+            c0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+            c1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+            c2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+            c3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+        }
+
+        // (a0 * f0 - a1 * f1) + a2 * f2
+        __m256d combine(__m256d a0, __m256d f0, __m256d a1, __m256d f1, __m256d a2, __m256d f2)
+        {
+            return _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(a0, f0), _mm256_mul_pd(a1, f1)), _mm256_mul_pd(a2, f2));
+        }
+
+        void multiply(const double* a, const double* b, double* out)
+        {
+            __m256d b0 { _mm256_load_pd(b) };
+            __m256d b1 { _mm256_load_pd(b + 4) };
+            __m256d b2 { _mm256_load_pd(b + 8) };
+            __m256d b3 { _mm256_load_pd(b + 12) };
+
+            for (int i = 0; i < 4; ++i)
+            {
+                // row i of the product = a[i][0] * row 0 of b + ... + a[i][3] * row 3 of b
+                __m256d row { _mm256_add_pd(_mm256_mul_pd(_mm256_broadcast_sd(a + i * 4), b0), _mm256_mul_pd(_mm256_broadcast_sd(a + i * 4 + 1), b1)) };
+                row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_broadcast_sd(a + i * 4 + 2), b2));
+                row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_broadcast_sd(a + i * 4 + 3), b3));
+                _mm256_store_pd(out + i * 4, row);
+            }
+        }
+
+        void transpose(const double* a, double* out)
+        {
+            __m256d c0, c1, c2, c3;
+            transposeRows(_mm256_load_pd(a), _mm256_load_pd(a + 4), _mm256_load_pd(a + 8), _mm256_load_pd(a + 12), c0, c1, c2, c3);
+            _mm256_store_pd(out, c0);
+            _mm256_store_pd(out + 4, c1);
+            _mm256_store_pd(out + 8, c2);
+            _mm256_store_pd(out + 12, c3);
+        }
+
+        void transform(const double* m, const Vec4* in, Vec4* out, std::size_t count)
+        {
+            // once per batch : the columns of m
+            __m256d c0, c1, c2, c3;
+            transposeRows(_mm256_load_pd(m), _mm256_load_pd(m + 4), _mm256_load_pd(m + 8), _mm256_load_pd(m + 12), c0, c1, c2, c3);
+
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                const double* v { &in[p].x };
+                __m256d r { _mm256_add_pd(_mm256_mul_pd(c0, _mm256_broadcast_sd(v)), _mm256_mul_pd(c1, _mm256_broadcast_sd(v + 1))) };
+                r = _mm256_add_pd(r, _mm256_mul_pd(c2, _mm256_broadcast_sd(v + 2)));
+                r = _mm256_add_pd(r, _mm256_mul_pd(c3, _mm256_broadcast_sd(v + 3)));
+                _mm256_store_pd(&out[p].x, r);
+            }
+        }
+
+        double inverse(const double* a, double* out)
+        {
+            auto m = [a](int r, int c) { return a[r * 4 + c]; };
+
+            // fac = x * y - z * w, lane by lane, with the same lanes as the scalar kernel
+            auto fac = [&](int c0, int c1) {
+                __m256d x { _mm256_setr_pd(m(2, c0), m(2, c0), m(1, c0), m(1, c0)) };
+                __m256d y { _mm256_setr_pd(m(3, c1), m(3, c1), m(3, c1), m(2, c1)) };
+                __m256d z { _mm256_setr_pd(m(3, c0), m(3, c0), m(3, c0), m(2, c0)) };
+                __m256d w { _mm256_setr_pd(m(2, c1), m(2, c1), m(1, c1), m(1, c1)) };
+                return _mm256_sub_pd(_mm256_mul_pd(x, y), _mm256_mul_pd(z, w));
+            };
+            __m256d fac0 { fac(2, 3) };
+            __m256d fac1 { fac(1, 3) };
+            __m256d fac2 { fac(1, 2) };
+            __m256d fac3 { fac(0, 3) };
+            __m256d fac4 { fac(0, 2) };
+            __m256d fac5 { fac(0, 1) };
+
+            __m256d vec0 { _mm256_setr_pd(m(1, 0), m(0, 0), m(0, 0), m(0, 0)) };
+            __m256d vec1 { _mm256_setr_pd(m(1, 1), m(0, 1), m(0, 1), m(0, 1)) };
+            __m256d vec2 { _mm256_setr_pd(m(1, 2), m(0, 2), m(0, 2), m(0, 2)) };
+            __m256d vec3 { _mm256_setr_pd(m(1, 3), m(0, 3), m(0, 3), m(0, 3)) };
+
+            __m256d signA { _mm256_setr_pd(1.0, -1.0, 1.0, -1.0) };
+            __m256d signB { _mm256_setr_pd(-1.0, 1.0, -1.0, 1.0) };
+            __m256d inv0 { _mm256_mul_pd(combine(vec1, fac0, vec2, fac1, vec3, fac2), signA) };
+            __m256d inv1 { _mm256_mul_pd(combine(vec0, fac0, vec2, fac3, vec3, fac4), signB) };
+            __m256d inv2 { _mm256_mul_pd(combine(vec0, fac1, vec1, fac3, vec3, fac5), signA) };
+            __m256d inv3 { _mm256_mul_pd(combine(vec0, fac2, vec1, fac4, vec2, fac5), signB) };
+
+            double determinant { (m(0, 0) * _mm256_cvtsd_f64(inv0) + m(0, 1) * _mm256_cvtsd_f64(inv1))
+                                 + (m(0, 2) * _mm256_cvtsd_f64(inv2) + m(0, 3) * _mm256_cvtsd_f64(inv3)) };
+            if (determinant == 0.0)
+                return determinant;
+
+            __m256d oneOverDeterminant { _mm256_set1_pd(1.0 / determinant) };
+            _mm256_store_pd(out, _mm256_mul_pd(inv0, oneOverDeterminant));
+            _mm256_store_pd(out + 4, _mm256_mul_pd(inv1, oneOverDeterminant));
+            _mm256_store_pd(out + 8, _mm256_mul_pd(inv2, oneOverDeterminant));
+            _mm256_store_pd(out + 12, _mm256_mul_pd(inv3, oneOverDeterminant));
+
+            return determinant;
+        }
+    }
+#pragma GCC pop_options
+#endif
+
+    bool hasAvx()
+    {
+#if SIMD_X86
+        static const bool supported { __builtin_cpu_supports("avx") != 0 };
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+#if SIMD_X86
+#define MATRIX_DISPATCH(call) return hasAvx() ? avx::call : scalar::call
+#else
+#define MATRIX_DISPATCH(call) return scalar::call
+#endif
+
+    void multiply(const double* a, const double* b, double* out) { MATRIX_DISPATCH(multiply(a, b, out)); }
+    void transpose(const double* a, double* out) { MATRIX_DISPATCH(transpose(a, out)); }
+    void transform(const double* m, const Vec4* in, Vec4* out, std::size_t count) { MATRIX_DISPATCH(transform(m, in, out, count)); }
+    double inverse(const double* a, double* out) { MATRIX_DISPATCH(inverse(a, out)); }
+
+#undef MATRIX_DISPATCH
+}
+#pragma GCC pop_options
+
+class Matrix
+{
+private:
+    alignas(32) double m_data[4][4]{};
+
+public:
+    static Matrix identity()
+    {
+        Matrix m {};
+        for (int i = 0; i < 4; ++i)
+            m.m_data[i][i] = 1.0;
+        return m;
+    }
+
+    double& operator()(int row, int col);
+    double operator()(int row, int col) const; // for const objects
+
+    const double* data() const { return &m_data[0][0]; }
+    double* data() { return &m_data[0][0]; }
+
+    Matrix transposed() const
+    {
+        Matrix result {};
+        matrixKernels::transpose(data(), result.data());
+        return result;
+    }
+
+    Matrix inverse() const
+    {
+        Matrix result {};
+        if (matrixKernels::inverse(data(), result.data()) == 0.0)
+            throw std::domain_error { "Matrix::inverse : the matrix is singular" };
+        return result;
+    }
+
+    friend Matrix operator*(const Matrix& a, const Matrix& b)
+    {
+        Matrix result {};
+        matrixKernels::multiply(a.data(), b.data(), result.data());
+        return result;
+    }
+
+    friend Vec4 operator*(const Matrix& m, const Vec4& v)
+    {
+        Vec4 result {};
+        matrixKernels::transform(m.data(), &v, &result, 1);
+        return result;
+    }
+};
+
+double& Matrix::operator()(int row, int col)
+{
+    assert(row >= 0 && row < 4);
+    assert(col >= 0 && col < 4);
+
+    return m_data[row][col];
+}
+
+double Matrix::operator()(int row, int col) const
+{
+    assert(row >= 0 && row < 4);
+    assert(col >= 0 && col < 4);
+
+    return m_data[row][col];
+}
+
+// out[i] = m * in[i], out may be the same span as in
+void transformPoints(const Matrix& m, std::span<const Vec4> in, std::span<Vec4> out)
+{
+    assert(in.size() == out.size());
+    matrixKernels::transform(m.data(), in.data(), out.data(), in.size());
+}
+
+// Rotation around z, then a translation
+Matrix makeTransform(double angle, double dx, double dy, double dz)
+{
+    Matrix m { Matrix::identity() };
+    m(0, 0) = std::cos(angle);
+    m(0, 1) = -std::sin(angle);
+    m(1, 0) = std::sin(angle);
+    m(1, 1) = std::cos(angle);
+    m(0, 3) = dx;
+    m(1, 3) = dy;
+    m(2, 3) = dz;
+    return m;
+}
+
 class Accumulator
 {
 private:
@@ -91,5 +464,66 @@ int main()
     std::cout << acc2(10) << '\n'; // prints 10
     std::cout << acc2(20) << '\n'; // prints 30
 
+    Matrix m { makeTransform(0.5, 1.0, 2.0, 3.0) * makeTransform(-0.25, 0.0, -1.0, 0.5) };
+    Matrix product { m * m.inverse() };
+    double error {};
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            error = std::max(error, std::abs(product(i, j) - (i == j ? 1.0 : 0.0)));
+    std::cout << "max |m * m.inverse() - I| : " << error << '\n';
+
+    try
+    {
+        Matrix flat { Matrix::identity() };
+        flat(2, 2) = 0.0;
+        (void)flat.inverse();
+    }
+    catch (const std::domain_error& exception)
+    {
+        std::cout << "Caught: " << exception.what() << '\n';
+    }
+
+    // 4M points through the pipeline : element by element with operator() vs one batch
+    std::vector<Vec4> points(1 << 22);
+    for (std::size_t i = 0; i < points.size(); ++i)
+        points[i] = Vec4 { static_cast<double>(i % 1000), static_cast<double>(i % 777), static_cast<double>(i % 555), 1.0 };
+    std::vector<Vec4> slow(points.size());
+    std::vector<Vec4> fast(points.size());
+
+    Timer t;
+    for (std::size_t p = 0; p < points.size(); ++p)
+    {
+        const double v[4] { points[p].x, points[p].y, points[p].z, points[p].w };
+        double r[4] {};
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                r[i] += m(i, j) * v[j];
+        slow[p] = Vec4 { r[0], r[1], r[2], r[3] };
+    }
+    double slowNs { t.elapsed() };
+
+    t.reset();
+    transformPoints(m, points, fast);
+    double fastNs { t.elapsed() };
+
+    double difference {};
+    for (std::size_t p = 0; p < points.size(); ++p)
+        difference = std::max({ difference, std::abs(slow[p].x - fast[p].x), std::abs(slow[p].y - fast[p].y), std::abs(slow[p].z - fast[p].z) });
+
+    std::cout << points.size() << " points : operator() loop " << slowNs / 1e6 << " ms, transformPoints (" << (matrixKernels::hasAvx() ? "avx" : "scalar")
+              << ") " << fastNs / 1e6 << " ms, max difference " << difference << '\n';
+
+    // the avx and scalar kernels agree bit for bit
+    std::vector<Vec4> reference(points.size());
+    matrixKernels::scalar::transform(m.data(), points.data(), reference.data(), points.size());
+    Matrix scalarInverse {};
+    matrixKernels::scalar::inverse(m.data(), scalarInverse.data());
+    Matrix scalarProduct {};
+    matrixKernels::scalar::multiply(m.data(), scalarInverse.data(), scalarProduct.data());
+    bool same { std::equal(reference.begin(), reference.end(), fast.begin(), [](const Vec4& a, const Vec4& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+    }) && std::equal(scalarProduct.data(), scalarProduct.data() + 16, product.data()) };
+    std::cout << "scalar and dispatched kernels give the same bits : " << same << '\n';
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,512 @@
+#include <iostream>
+/*
+    Notes :
+
+    1. What is wrong with "Timer t; ...; std::cout << t.elapsed()" ?
+
+        - One run measures one sample of a noisy process : the first run pays for cold caches, page faults and CPU frequency ramp up, and any run can be interrupted by the OS. Two runs of the same program can easily differ by 20%.
+
+        - The optimizer may delete the work entirely. If the result of a loop is never used, the compiler is allowed to remove the loop, and we end up timing nothing.
+
+        - A single number gives no idea of how much it can be trusted, so we can't tell a real 5% improvement from noise.
+
+    2. What the harness does for each benchmark :
+
+        1. Calibrate : double the number of iterations per sample until one sample takes at least minSampleTime, so the clock's resolution and the cost of reading it don't matter.
+
+        2. Warm up : run for warmupTime without recording, to fill the caches, fault in the memory and let the CPU clock up.
+
+        3. Sample until the result is stable : after minSamples samples, compute the 95% confidence interval of the mean. Stop as soon as its half width is below targetPrecision of the mean (1% by default), or when maxSamples / maxTime is reached (the result is then flagged as not converged). The harness refuses options where maxSamples < minSamples or minSamples < 2, since no interval could ever be computed.
+
+                half width = t(95%, n - 1) * stddev / sqrt(n)
+
+        4. Report the mean, median and standard deviation of the time per iteration, and the throughput (items per second). The mean and variance are updated with Welford's method, sumOfSquares - n * mean * mean would cancel out almost every digit when the samples are close together.
+
+    3. Keeping the optimizer honest :
+
+        - doNotOptimize(value) : an empty asm statement that claims to read value, so the compiler must actually compute it and can't delete the code producing it.
+
+        - clobberMemory() : an empty asm statement that claims to read and write all of memory, so stores before it can't be removed or moved past it.
+
+            DynamicArray<int> copy { arr };
+            doNotOptimize(copy);    // the copy must really happen
+            clobberMemory();        // and its writes to memory too
+
+        - Both are GCC/Clang inline assembly; the generated code is empty.
+
+    4. Output :
+
+        - By default a table is printed. Run with --csv or --json for machine readable output, and --filter=<text> to only run the benchmarks whose name contains text :
+
+            ./benchmarkHarness --json --filter=DynamicArray > results.json
+
+        - The suites here are the copy vs move comparisons from the move semantics notes, so the numbers can be compared across machines and compilers.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>       // for std::snprintf
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobberMemory()
+{
+    asm volatile("" : : : "memory");
+}
+
+struct BenchmarkOptions
+{
+    double warmupTime { 0.1 };          // seconds
+    double minSampleTime { 0.002 };     // seconds per sample
+    double maxTime { 3.0 };             // seconds per benchmark, after warmup
+    int minSamples { 10 };
+    int maxSamples { 2000 };
+    double targetPrecision { 0.01 };    // half width of the 95% confidence interval / mean
+};
+
+struct BenchmarkResult
+{
+    std::string name {};
+    long long iterationsPerSample {};
+    int samples {};
+    double meanNs {};                   // per iteration
+    double medianNs {};
+    double stddevNs {};
+    double ciHalfWidthNs {};
+    double itemsPerSecond {};
+    bool converged {};
+};
+
+class BenchmarkHarness
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Benchmark
+    {
+        std::string name {};
+        double itemsPerIteration {};
+        std::function<void(long long)> body {};   // runs the measured code the given number of times
+    };
+
+    std::vector<Benchmark> m_benchmarks {};
+    BenchmarkOptions m_options {};
+
+public:
+    // The confidence interval needs at least 2 samples, and maxSamples must leave room for minSamples,
+    // otherwise no sample would ever be summarized and a mean of 0 would be reported as a result
+    explicit BenchmarkHarness(BenchmarkOptions options = {}) : m_options{ options }
+    {
+        if (options.minSamples < 2 || options.maxSamples < options.minSamples)
+            throw std::invalid_argument { "BenchmarkOptions needs 2 <= minSamples <= maxSamples" };
+    }
+
+    void add(std::string name, double itemsPerIteration, std::function<void(long long)> body)
+    {
+        m_benchmarks.push_back({ std::move(name), itemsPerIteration, std::move(body) });
+    }
+
+    std::vector<BenchmarkResult> run(std::string_view filter = {}) const
+    {
+        std::vector<BenchmarkResult> results {};
+        for (const auto& benchmark : m_benchmarks)
+        {
+            if (benchmark.name.find(filter) != std::string::npos)
+                results.push_back(measure(benchmark));
+        }
+        return results;
+    }
+
+private:
+    static double secondsOf(const std::function<void(long long)>& body, long long iterations)
+    {
+        auto begin { Clock::now() };
+        body(iterations);
+        clobberMemory();
+        return std::chrono::duration<double>(Clock::now() - begin).count();
+    }
+
+    // two-sided 95% Student's t value for the given degrees of freedom
+    static double tValue95(int degrees)
+    {
+        static constexpr double table[] {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+        };
+        if (degrees < 1)
+            return table[0];
+        return degrees <= 30 ? table[degrees - 1] : 1.96;
+    }
+
+    BenchmarkResult measure(const Benchmark& benchmark) const
+    {
+        // 1. calibrate
+        long long iterations { 1 };
+        while (secondsOf(benchmark.body, iterations) < m_options.minSampleTime && iterations < (1LL << 40))
+            iterations *= 2;
+
+        // 2. warm up
+        auto warmupEnd { Clock::now() + std::chrono::duration<double>(m_options.warmupTime) };
+        while (Clock::now() < warmupEnd)
+            secondsOf(benchmark.body, iterations);
+
+        // 3. sample until the confidence interval is narrow enough
+        BenchmarkResult result { benchmark.name, iterations };
+        std::vector<double> samples {};
+        double mean {};
+        double sumOfSquaredDeviations {}; // Welford : no sumOfSquares - n * mean * mean cancellation
+        auto deadline { Clock::now() + std::chrono::duration<double>(m_options.maxTime) };
+
+        while (static_cast<int>(samples.size()) < m_options.maxSamples)
+        {
+            double ns { secondsOf(benchmark.body, iterations) * 1e9 / static_cast<double>(iterations) };
+            samples.push_back(ns);
+
+            int n { static_cast<int>(samples.size()) };
+            double delta { ns - mean };
+            mean += delta / n;
+            sumOfSquaredDeviations += delta * (ns - mean);
+
+            if (n < m_options.minSamples)
+                continue;
+
+            result.meanNs = mean;
+            result.stddevNs = std::sqrt(sumOfSquaredDeviations / (n - 1));
+            result.ciHalfWidthNs = tValue95(n - 1) * result.stddevNs / std::sqrt(static_cast<double>(n));
+
+            if (result.ciHalfWidthNs <= m_options.targetPrecision * result.meanNs)
+            {
+                result.converged = true;
+                break;
+            }
+            if (Clock::now() >= deadline)
+                break;
+        }
+
+        // 4. summarize
+        result.samples = static_cast<int>(samples.size());
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        result.medianNs = samples[samples.size() / 2];
+        result.itemsPerSecond = result.meanNs > 0 ? benchmark.itemsPerIteration * 1e9 / result.meanNs : 0;
+
+        return result;
+    }
+};
+
+void printTable(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+    out << "benchmark                           mean(ns)   median(ns)   stddev(ns)    +-95%   samples     items/s\n";
+    for (const auto& r : results)
+    {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-32s %11.1f %12.1f %12.1f %7.2f%% %9d %11.3g%s\n",
+            r.name.c_str(), r.meanNs, r.medianNs, r.stddevNs, 100.0 * r.ciHalfWidthNs / r.meanNs, r.samples,
+            r.itemsPerSecond, r.converged ? "" : "  (not converged)");
+        out << line;
+    }
+}
+
+void printCsv(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+    out << "name,iterations_per_sample,samples,mean_ns,median_ns,stddev_ns,ci95_ns,items_per_second,converged\n";
+    for (const auto& r : results)
+    {
+        out << r.name << ',' << r.iterationsPerSample << ',' << r.samples << ',' << r.meanNs << ',' << r.medianNs << ','
+            << r.stddevNs << ',' << r.ciHalfWidthNs << ',' << r.itemsPerSecond << ',' << (r.converged ? "true" : "false") << '\n';
+    }
+}
+
+void printJson(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+    out << "{\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+        << ",\n  \"compiler\": \"" << __VERSION__ << "\",\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& r { results[i] };
+        out << "    { \"name\": \"" << r.name << "\""
+            << ", \"iterations_per_sample\": " << r.iterationsPerSample
+            << ", \"samples\": " << r.samples
+            << ", \"mean_ns\": " << r.meanNs
+            << ", \"median_ns\": " << r.medianNs
+            << ", \"stddev_ns\": " << r.stddevNs
+            << ", \"ci95_ns\": " << r.ciHalfWidthNs
+            << ", \"items_per_second\": " << r.itemsPerSecond
+            << ", \"converged\": " << (r.converged ? "true" : "false") << " }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+// ---------------------------------------------------------------------------------------------
+// The classes under test, from Move Semantics and Smart Pointers/003_moveConstructorAndAssignment.cpp
+// (without the printing, which would dominate the timings)
+
+template<typename T>
+class Auto_ptr3
+{
+	T* m_ptr {};
+
+public:
+	Auto_ptr3(T* ptr = nullptr)
+		: m_ptr { ptr }
+	{
+	}
+
+	~Auto_ptr3()
+	{
+		delete m_ptr;
+	}
+
+	// Copy constructor
+	// Do deep copy of a.m_ptr to m_ptr
+	Auto_ptr3(const Auto_ptr3& a)
+	{
+		m_ptr = new T;
+		*m_ptr = *a.m_ptr;
+	}
+
+	// Copy assignment
+	// Do deep copy of a.m_ptr to m_ptr
+	Auto_ptr3& operator=(const Auto_ptr3& a)
+	{
+		if (&a == this)
+			return *this;
+
+		delete m_ptr;
+		m_ptr = new T;
+		*m_ptr = *a.m_ptr;
+
+		return *this;
+	}
+
+    // move constructor
+    Auto_ptr3(Auto_ptr3 &&a) noexcept
+    : m_ptr(a.m_ptr)
+    {
+        a.m_ptr = nullptr;
+    }
+
+    // move assignment
+    Auto_ptr3& operator=(Auto_ptr3 &&a) noexcept
+    {
+        if(this == &a)
+        {
+            return *this;
+        }
+
+        delete m_ptr;
+        m_ptr = a.m_ptr;
+        a.m_ptr = nullptr;
+
+        return *this;
+    }
+
+	T& operator*() const { return *m_ptr; }
+	T* operator->() const { return m_ptr; }
+	bool isNull() const { return m_ptr == nullptr; }
+};
+
+class Resource
+{
+    int m_data[64] {};
+
+public:
+    int& operator[](int index) { return m_data[index]; }
+};
+
+template <typename T>
+class DynamicArray
+{
+    T * _arr;
+    int _len;
+
+    public:
+
+    DynamicArray(int size) : _arr{new T[size]} , _len{size}
+    {
+
+    }
+
+    ~DynamicArray()
+    {
+        delete [] _arr;
+    }
+
+    // copy constructor
+    DynamicArray(const DynamicArray& copy) :
+    _len{copy._len}
+    {
+        _arr = new T[_len];
+        std::copy_n(copy._arr , _len , _arr);
+    }
+
+    // copy assignment
+    DynamicArray& operator=(const DynamicArray &copy)
+    {
+        if(this == &copy)
+        {
+            return *this;
+        }
+
+        delete [] _arr;
+        _len = copy._len;
+        _arr = new T[_len];
+
+        std::copy_n(copy._arr , _len , _arr);
+
+        return *this;
+    }
+
+    // move constructor
+    DynamicArray(DynamicArray &&copy) noexcept
+    : _arr{copy._arr} , _len{copy._len}
+    {
+        copy._len = 0;
+        copy._arr = nullptr;
+    }
+
+    // move assignment
+    DynamicArray & operator=(DynamicArray && copy) noexcept
+    {
+
+        if(this == &copy)
+        {
+            return *this;
+        }
+
+        delete [] _arr;
+
+        _len = copy._len;
+        _arr = copy._arr;
+
+        copy._len = 0;
+        copy._arr = nullptr;
+
+        return *this;
+    }
+
+    int getLength() const
+    {
+        return _len;
+    }
+
+    T & operator[](int index)
+    {
+        return _arr[index];
+    }
+
+    const T & operator[](int index) const
+    {
+        return _arr[index];
+    }
+};
+
+// ---------------------------------------------------------------------------------------------
+// Suites
+
+void addDynamicArraySuite(BenchmarkHarness& harness)
+{
+    for (int size : { 1000, 1000000 })
+    {
+        std::string suffix { "/" + std::to_string(size) };
+
+        // built once, outside the measured code
+        auto arr { std::make_shared<DynamicArray<int>>(size) };
+        for (int i = 0; i < size; ++i)
+            (*arr)[i] = i;
+
+        harness.add("DynamicArray/copy" + suffix, size, [arr](long long iterations) {
+            for (long long i = 0; i < iterations; ++i)
+            {
+                DynamicArray<int> copy { *arr };
+                doNotOptimize(copy);
+                clobberMemory();
+            }
+        });
+
+        // two moves per iteration : out of arr and back, so arr is intact for the next sample. A move is O(1), so the items are the 2 moves, not the elements
+        harness.add("DynamicArray/move" + suffix, 2, [arr](long long iterations) {
+            for (long long i = 0; i < iterations; ++i)
+            {
+                DynamicArray<int> moved { std::move(*arr) };
+                doNotOptimize(moved);
+                *arr = std::move(moved);
+            }
+            clobberMemory();
+        });
+    }
+}
+
+void addAutoPtrSuite(BenchmarkHarness& harness)
+{
+    auto res { std::make_shared<Auto_ptr3<Resource>>(new Resource) };
+
+    harness.add("Auto_ptr3/copy", 1, [res](long long iterations) {
+        for (long long i = 0; i < iterations; ++i)
+        {
+            Auto_ptr3<Resource> copy { *res };
+            doNotOptimize(*copy);
+        }
+    });
+
+    // out of res and back : two moves per iteration
+    harness.add("Auto_ptr3/move", 2, [res](long long iterations) {
+        for (long long i = 0; i < iterations; ++i)
+        {
+            Auto_ptr3<Resource> moved { std::move(*res) };
+            doNotOptimize(*moved);
+            *res = std::move(moved);
+        }
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    enum class Format { table, csv, json } format { Format::table };
+    std::string_view filter {};
+
+    for (int count { 1 }; count < argc; ++count)
+    {
+        std::string_view arg { argv[count] };
+        if (arg == "--csv")
+            format = Format::csv;
+        else if (arg == "--json")
+            format = Format::json;
+        else if (arg.substr(0, 9) == "--filter=")
+            filter = arg.substr(9);
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--csv | --json] [--filter=<text>]\n";
+            return 1;
+        }
+    }
+
+    BenchmarkHarness harness {};
+    addDynamicArraySuite(harness);
+    addAutoPtrSuite(harness);
+
+    auto results { harness.run(filter) };
+
+    switch (format)
+    {
+    case Format::table: printTable(std::cout, results); break;
+    case Format::csv:   printCsv(std::cout, results); break;
+    case Format::json:  printJson(std::cout, results); break;
+    }
+
+    return 0;
+}
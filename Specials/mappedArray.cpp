@@ -0,0 +1,454 @@
+#include <iostream>
+/*
+    Notes :
+
+    1. Why map a file instead of reading it ?
+
+        - Loading a column of ints into a DynamicArray means new int[n] and then read() : every byte is copied from the kernel's page cache into our array, and the whole array has to fit in RAM before we can use it.
+
+        - mmap() asks the kernel to make the file's pages appear in our address space. Nothing is read when the file is opened : the first access to a page causes a page fault, and the kernel brings in that page (and usually a few after it). Pages that are not used are never read, and pages that have not been touched for a while can be dropped by the kernel, so the file can be much larger than RAM.
+
+        - Opening a multi GB file this way takes microseconds, and the data is shared with the page cache (zero copy).
+
+    2. MappedArray<T> :
+
+        - Same interface as DynamicArray for reading and writing elements : operator[] and getLength(). T must be trivially copyable, because its bytes are the file's bytes.
+
+        - Like DynamicArray it owns a resource (the file descriptor and the mapping), so it is move only : copying would need a second mapping with its own meaning.
+
+    3. Modes :
+
+            readOnly     : PROT_READ, writing to an element crashes (SIGSEGV)
+            copyOnWrite  : MAP_PRIVATE, writes go to private copies of the touched pages, the file never changes
+            shared       : MAP_SHARED, writes go to the page cache and from there to the file, other processes mapping the file see them
+
+        - Only a shared array can grow or be resized, because that changes the file. resize() on the other modes throws before touching anything.
+
+    4. Growth :
+
+        - push_back() and resize() first make the file bigger with ftruncate(), then the mapping with mremap() (Linux). mremap can grow the mapping in place or move it to another address without copying anything, the pages stay where they are.
+
+        - Like DynamicArray, the capacity grows geometrically, so the file is padded. The destructor truncates the file back to the real length.
+
+        - Since the mapping may move, pointers and references to elements are invalidated by growth (same as DynamicArray).
+
+    5. Access hints (madvise) :
+
+            sequential : read ahead aggressively, pages behind us can be dropped early
+            random     : don't read ahead, each fault reads only what is needed
+            willNeed   : start reading the whole range now, in the background
+
+        - They are only hints, the results are the same with or without them.
+
+    6. Errors are reported with std::system_error, holding the errno of the call that failed.
+
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+enum class MapMode
+{
+    readOnly,
+    copyOnWrite,
+    shared,
+};
+
+enum class AccessHint
+{
+    normal,
+    sequential,
+    random,
+    willNeed,
+};
+
+template <typename T>
+class MappedArray
+{
+    static_assert(std::is_trivially_copyable_v<T>, "a mapped element is just the bytes in the file");
+
+    int _fd;
+    MapMode _mode;
+    T * _arr;       // nullptr while nothing is mapped (empty file)
+    long long _len;
+    long long _cap;
+
+    static void check(bool ok, const char *what)
+    {
+        if (!ok)
+            throw std::system_error{errno, std::generic_category(), what};
+    }
+
+    MappedArray(int fd, MapMode mode, long long len) : _fd{fd} , _mode{mode} , _arr{nullptr} , _len{len} , _cap{len}
+    {
+        if (_cap > 0)
+        {
+            try
+            {
+                _arr = map(_cap);
+            }
+            catch (...)
+            {
+                ::close(_fd); // the destructor won't run
+                throw;
+            }
+        }
+    }
+
+    T * map(long long cap) const
+    {
+        int prot { _mode == MapMode::readOnly ? PROT_READ : PROT_READ | PROT_WRITE };
+        int flags { _mode == MapMode::shared ? MAP_SHARED : MAP_PRIVATE };
+
+        void *arr { ::mmap(nullptr, sizeof(T) * cap, prot, flags, _fd, 0) };
+        check(arr != MAP_FAILED, "mmap");
+
+        return static_cast<T *>(arr);
+    }
+
+    void growTo(long long newCap)
+    {
+        if (_mode != MapMode::shared)
+            throw std::system_error{std::make_error_code(std::errc::operation_not_permitted), "only a shared MappedArray can grow"};
+
+        check(::ftruncate(_fd, static_cast<off_t>(sizeof(T) * newCap)) == 0, "ftruncate");
+
+        if (!_arr)
+        {
+            _arr = map(newCap);
+        }
+        else
+        {
+#ifdef __linux__
+            void *arr { ::mremap(_arr, sizeof(T) * _cap, sizeof(T) * newCap, MREMAP_MAYMOVE) };
+            check(arr != MAP_FAILED, "mremap");
+            _arr = static_cast<T *>(arr);
+#else
+            ::munmap(_arr, sizeof(T) * _cap);
+            _arr = map(newCap);
+#endif
+        }
+        _cap = newCap;
+    }
+
+    void release() noexcept
+    {
+        if (_arr)
+            ::munmap(_arr, sizeof(T) * _cap);
+
+        // drop the padding left by geometric growth
+        if (_mode == MapMode::shared && _cap != _len)
+            (void)::ftruncate(_fd, static_cast<off_t>(sizeof(T) * _len));
+
+        if (_fd >= 0)
+            ::close(_fd);
+    }
+
+    public:
+
+    // Map an existing file. Nothing is read until the elements are used.
+    static MappedArray open(const std::string &path, MapMode mode = MapMode::readOnly)
+    {
+        int fd { ::open(path.c_str(), mode == MapMode::shared ? O_RDWR : O_RDONLY) };
+        check(fd >= 0, "open");
+
+        struct stat info {};
+        if (::fstat(fd, &info) != 0)
+        {
+            int error { errno };
+            ::close(fd);
+            errno = error;
+            check(false, "fstat");
+        }
+
+        return MappedArray{fd, mode, static_cast<long long>(info.st_size) / static_cast<long long>(sizeof(T))};
+    }
+
+    // Create (or truncate) a file holding length zeroed elements, mapped shared
+    static MappedArray create(const std::string &path, long long length = 0)
+    {
+        int fd { ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) };
+        check(fd >= 0, "open");
+
+        MappedArray arr{fd, MapMode::shared, 0};
+        arr.resize(length);
+
+        return arr;
+    }
+
+    ~MappedArray()
+    {
+        release();
+    }
+
+    MappedArray(const MappedArray& copy) = delete;
+    MappedArray& operator=(const MappedArray &copy) = delete;
+
+    MappedArray(MappedArray &&copy) noexcept
+    : _fd{copy._fd} , _mode{copy._mode} , _arr{copy._arr} , _len{copy._len} , _cap{copy._cap}
+    {
+        copy._fd = -1;
+        copy._arr = nullptr;
+        copy._len = 0;
+        copy._cap = 0;
+    }
+
+    MappedArray & operator=(MappedArray && copy) noexcept
+    {
+        if(this == &copy)
+        {
+            return *this;
+        }
+
+        release();
+        _fd = std::exchange(copy._fd, -1);
+        _mode = copy._mode;
+        _arr = std::exchange(copy._arr, nullptr);
+        _len = std::exchange(copy._len, 0);
+        _cap = std::exchange(copy._cap, 0);
+
+        return *this;
+    }
+
+    // New elements are zero, like the bytes ftruncate adds to a file. Only a shared array can be resized, and nothing changes if it throws.
+    void resize(long long newLen)
+    {
+        if (_mode != MapMode::shared)
+            throw std::system_error{std::make_error_code(std::errc::operation_not_permitted), "only a shared MappedArray can be resized"};
+        if (newLen < 0)
+            throw std::system_error{std::make_error_code(std::errc::invalid_argument), "negative MappedArray length"};
+
+        long long oldCap { _cap };
+        if (newLen > _cap)
+            growTo(newLen);
+
+        // elements left over from a shrink are still in the file, only the bytes past the old capacity come zeroed from ftruncate
+        if (newLen > _len && _len < oldCap)
+            std::fill(_arr + _len, _arr + std::min(newLen, oldCap), T{});
+
+        _len = newLen;
+    }
+
+    void reserve(long long newCap)
+    {
+        if (newCap > _cap)
+            growTo(newCap);
+    }
+
+    void push_back(const T &value)
+    {
+        if (_len == _cap)
+        {
+            T copy { value }; // value may be one of our elements, and the mapping may move
+            growTo(std::max(_cap * 2, 4096 / static_cast<long long>(sizeof(T)) + 1));
+            _arr[_len++] = copy;
+        }
+        else
+        {
+            _arr[_len++] = value;
+        }
+    }
+
+    void advise(AccessHint hint, long long begin = 0, long long end = -1) const
+    {
+        if (!_arr)
+            return;
+
+        static const long pageSize { ::sysconf(_SC_PAGESIZE) };
+
+        // madvise wants a page aligned start
+        end = end < 0 ? _len : end;
+        auto first { reinterpret_cast<std::uintptr_t>(_arr + begin) / pageSize * pageSize };
+        auto last { reinterpret_cast<std::uintptr_t>(_arr + end) };
+        if (last <= first)
+            return;
+
+        int advice { MADV_NORMAL };
+        switch (hint)
+        {
+            case AccessHint::normal: advice = MADV_NORMAL; break;
+            case AccessHint::sequential: advice = MADV_SEQUENTIAL; break;
+            case AccessHint::random: advice = MADV_RANDOM; break;
+            case AccessHint::willNeed: advice = MADV_WILLNEED; break;
+        }
+
+        check(::madvise(reinterpret_cast<void *>(first), last - first, advice) == 0, "madvise");
+    }
+
+    // Write the dirty pages of a shared array to the file now, instead of whenever the kernel decides
+    void sync() const
+    {
+        if (_arr && _mode == MapMode::shared)
+            check(::msync(_arr, sizeof(T) * _len, MS_SYNC) == 0, "msync");
+    }
+
+    long long getLength() const
+    {
+        return _len;
+    }
+
+    MapMode getMode() const
+    {
+        return _mode;
+    }
+
+    T & operator[](long long index)
+    {
+        return _arr[index];
+    }
+
+    const T & operator[](long long index) const
+    {
+        return _arr[index];
+    }
+};
+
+int main()
+{
+    const std::string path { "/tmp/mappedArray.bin" };
+    constexpr long long count { 1LL << 25 }; // 128 MB of ints
+
+    // write the column through a shared mapping, growing it one push_back at a time
+    {
+        Timer t;
+        MappedArray<int> column { MappedArray<int>::create(path) };
+        for (long long i = 0; i < count; ++i)
+            column.push_back(static_cast<int>(i % 1000));
+        column.sync();
+        std::cout << "write " << column.getLength() << " ints : " << t.elapsed() / 1e6 << " ms\n";
+    }
+
+    // classic load : new int[] + read(), every byte is copied
+    {
+        Timer t;
+        int fd { ::open(path.c_str(), O_RDONLY) };
+        int *arr { new int[count] };
+        char *bytes { reinterpret_cast<char *>(arr) };
+        std::size_t remaining { sizeof(int) * count };
+        while (remaining > 0)
+        {
+            ssize_t n { ::read(fd, bytes, remaining) };
+            if (n <= 0)
+                break;
+            bytes += n;
+            remaining -= static_cast<std::size_t>(n);
+        }
+        ::close(fd);
+        double loadNs { t.elapsed() };
+
+        long long sum {};
+        for (long long i = 0; i < count; ++i)
+            sum += arr[i];
+        std::cout << "new int[] + read : load " << loadNs / 1e6 << " ms, load + sum " << t.elapsed() / 1e6 << " ms (sum " << sum << ")\n";
+        delete [] arr;
+    }
+
+    // zero copy : the open is instant, the pages come in while summing
+    {
+        Timer t;
+        const MappedArray<int> column { MappedArray<int>::open(path) };
+        double openNs { t.elapsed() };
+
+        column.advise(AccessHint::sequential);
+        long long sum {};
+        for (long long i = 0; i < column.getLength(); ++i)
+            sum += column[i];
+        std::cout << "mmap             : open " << openNs / 1e6 << " ms, open + sum " << t.elapsed() / 1e6 << " ms (sum " << sum << ")\n";
+    }
+
+    // copy on write : scribble on a private view, the file stays the same
+    {
+        MappedArray<int> scratch { MappedArray<int>::open(path, MapMode::copyOnWrite) };
+        scratch.advise(AccessHint::random);
+        for (long long i = 0; i < scratch.getLength(); i += 1000003)
+            scratch[i] = -1;
+
+        const MappedArray<int> check { MappedArray<int>::open(path) };
+        std::cout << "copy on write : scratch[0] = " << scratch[0] << ", file[0] = " << check[0] << '\n';
+
+        try
+        {
+            scratch.push_back(1);
+        }
+        catch (const std::system_error &error)
+        {
+            std::cout << "Caught: " << error.what() << '\n';
+        }
+
+        // resize is refused up front, so the elements past the new length are not zeroed by a call that fails
+        try
+        {
+            scratch.resize(scratch.getLength() + 1);
+        }
+        catch (const std::system_error &error)
+        {
+            std::cout << "Caught: " << error.what() << ", length " << scratch.getLength() << ", scratch[1] = " << scratch[1] << '\n';
+        }
+    }
+
+    // read only : writing would crash, so resize must throw before it writes anything
+    {
+        MappedArray<int> readOnly { MappedArray<int>::open(path) };
+        try
+        {
+            readOnly.resize(1);
+        }
+        catch (const std::system_error &error)
+        {
+            std::cout << "Caught: " << error.what() << ", length " << readOnly.getLength() << ", readOnly[1] = " << readOnly[1] << '\n';
+        }
+    }
+
+    // shared : shrink, then grow back, the old elements come back as zeros
+    {
+        MappedArray<int> column { MappedArray<int>::open(path, MapMode::shared) };
+        column.resize(1);
+        column.resize(3);
+        std::cout << "shrink to 1 and grow to 3 : " << column[0] << ' ' << column[1] << ' ' << column[2] << '\n';
+
+        try
+        {
+            column.resize(-1);
+        }
+        catch (const std::system_error &error)
+        {
+            std::cout << "Caught: " << error.what() << ", length " << column.getLength() << '\n';
+        }
+    }
+
+    std::remove(path.c_str());
+
+    return 0;
+}
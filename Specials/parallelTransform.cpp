@@ -0,0 +1,668 @@
+#include <iostream>
+/*
+    Notes :
+
+    1. Why a parallel transform ?
+
+        - cloneArrayAndDouble from the move semantics notes runs on one core. Every element is independent of the others, so the array can be cut into pieces and each piece handed to a different core.
+
+        - For very large arrays this also buys memory bandwidth : a single core cannot saturate the memory bus on its own, several cores can.
+
+    2. A reusable worker pool :
+
+        - Starting a std::thread costs tens of microseconds. Doing that on every call would eat the gain for anything but huge arrays, so the threads are created once in a ThreadPool and wait on a condition variable for work.
+
+        - ThreadPool::submit() puts a task in a queue and wakes one worker. The destructor asks the workers to stop and joins them (RAII, like any other resource).
+
+    3. Chunks :
+
+        - The range is cut into chunks of grainSize elements. A chunk should be "cache-sized" : big enough that the cost of grabbing it is nothing compared to the work, small enough that its input and output stay in the core's cache, and that there are many more chunks than threads.
+
+        - Chunks are not assigned up front. Each thread takes the next chunk with an atomic fetch_add until none are left (dynamic scheduling), so a thread that was slowed down (by the OS, by another process) simply takes fewer chunks.
+
+        - The calling thread works on chunks too instead of sleeping.
+
+    4. ParallelConfig :
+
+            threadCount       : threads to use, including the caller (0 = the pool's threads + the caller)
+            grainSize         : elements per chunk (0 = 256 KB worth of elements)
+            sequentialCutoff  : below this many elements, don't use any other thread
+
+        - The cutoff matters : waking up threads costs a few microseconds, which is more than doubling a few thousand ints takes.
+
+    5. Safety :
+
+        - If the function throws, the first exception is saved, the remaining chunks are skipped and the exception is rethrown in the calling thread.
+
+        - Helper tasks hold the shared state by std::shared_ptr. A helper that only gets to run after the caller has finished (because the pool was busy) sees the work is closed and returns without touching anything on the caller's stack, so the caller never waits on a task that hasn't started. That also makes it safe to call parallelFor from inside a pool task.
+
+    6. Parallel reduction : a sum, a min/max, a count or a histogram over a big array combines all of the elements into one value. That can be split over threads too, as long as the way values are combined is a monoid :
+
+            = an identity value            0 for a sum, { INT_MAX, INT_MIN } for MinMax, an empty histogram
+            = an associative combine       (a + b) + c == a + (b + c), like MinMax's operator+ from Operator Overloading/002_overloadingArithmeticUsingFriend.cpp
+
+        - parallelReduce(pool, arr, identity, combine) : each chunk is reduced on its own (a leaf), starting from the identity, then the per-chunk results are combined.
+
+        - A monoid can also be a class with identity(), combine(a, b) and leaf(first, last). Its leaf can be faster than calling combine element by element : SumMonoid and MinMaxMonoid keep 8 independent partial results, which the compiler turns into SIMD instructions (and even without SIMD, the 8 additions don't wait on each other). SumMonoid, MinMaxMonoid, CountMonoid and HistogramMonoid are provided.
+
+    7. Deterministic results : floating point addition is not associative, so a parallel sum whose grouping depends on which thread finished first changes in the last bits from run to run. parallelReduce avoids that :
+
+            = the chunks depend only on the array length and the grain size, never on the number of threads (even below the sequential cutoff, the same chunks are used)
+            = each chunk writes its result in its own slot, partials[chunk]
+            = the slots are combined in a fixed binary tree : (0 + 1) + (2 + 3), ...
+
+        - So the result is the same bits with 1 thread or 64, on every run. It may still differ from a plain serial loop, which groups the additions differently.
+
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+// The fixed size DynamicArray from Move Semantics and Smart Pointers/003_moveConstructorAndAssignment.cpp
+template <typename T>
+class DynamicArray
+{
+    T * _arr;
+    int _len;
+
+    public:
+
+    DynamicArray(int size) : _arr{new T[size]} , _len{size}
+    {
+
+    }
+
+    ~DynamicArray()
+    {
+        delete [] _arr;
+    }
+
+    DynamicArray(const DynamicArray& copy) = delete;
+    DynamicArray& operator=(const DynamicArray &copy) = delete;
+
+    DynamicArray(DynamicArray &&copy) noexcept
+    : _arr{copy._arr} , _len{copy._len}
+    {
+        copy._len = 0;
+        copy._arr = nullptr;
+    }
+
+    DynamicArray & operator=(DynamicArray && copy) noexcept
+    {
+        if(this == &copy)
+        {
+            return *this;
+        }
+
+        delete [] _arr;
+        _len = copy._len;
+        _arr = copy._arr;
+        copy._len = 0;
+        copy._arr = nullptr;
+
+        return *this;
+    }
+
+    int getLength() const
+    {
+        return _len;
+    }
+
+    T & operator[](int index)
+    {
+        return _arr[index];
+    }
+
+    const T & operator[](int index) const
+    {
+        return _arr[index];
+    }
+};
+
+class ThreadPool
+{
+    std::vector<std::thread> m_threads {};
+    std::deque<std::function<void()>> m_tasks {};
+    std::mutex m_mutex {};
+    std::condition_variable m_wake {};
+    bool m_stopping {};
+
+public:
+    explicit ThreadPool(int threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1))
+    {
+        for (int i = 0; i < threadCount; ++i)
+            m_threads.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock { m_mutex };
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int getThreadCount() const { return static_cast<int>(m_threads.size()); }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock { m_mutex };
+            m_tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+
+private:
+    void workerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task {};
+            {
+                std::unique_lock lock { m_mutex };
+                m_wake.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return; // stopping, and nothing left to do
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+struct ParallelConfig
+{
+    int threadCount {};                 // including the caller, 0 = all of the pool + the caller
+    int grainSize {};                   // elements per chunk, 0 = defaultChunkBytes worth
+    int sequentialCutoff { 1 << 16 };   // below this many elements, stay on the calling thread
+
+    static constexpr int defaultChunkBytes { 256 * 1024 };
+};
+
+// Call body(begin, end) for consecutive chunks covering [0, count), on the pool and the calling thread
+template <typename Body>
+void parallelFor(ThreadPool& pool, int count, int grainSize, const ParallelConfig& config, Body body)
+{
+    int threads { config.threadCount > 0 ? config.threadCount : pool.getThreadCount() + 1 };
+    if (count <= config.sequentialCutoff || threads <= 1)
+    {
+        body(0, count);
+        return;
+    }
+
+    struct State
+    {
+        std::mutex mutex {};
+        std::condition_variable finished {};
+        int running {};
+        bool closed {};
+        std::atomic<int> nextChunk {};
+        std::atomic<bool> failed {};
+        std::exception_ptr error {};
+    };
+
+    auto state { std::make_shared<State>() };
+    int chunks { (count + grainSize - 1) / grainSize };
+
+    auto work = [&state = *state, &body, count, grainSize, chunks] {
+        for (int chunk { state.nextChunk.fetch_add(1) }; chunk < chunks; chunk = state.nextChunk.fetch_add(1))
+        {
+            if (state.failed.load(std::memory_order_relaxed))
+                continue; // skip the rest, but still drain the counter
+
+            try
+            {
+                int begin { chunk * grainSize };
+                body(begin, std::min(count, begin + grainSize));
+            }
+            catch (...)
+            {
+                std::lock_guard lock { state.mutex };
+                if (!state.error)
+                    state.error = std::current_exception();
+                state.failed = true;
+            }
+        }
+    };
+
+    int helpers { std::min({ threads - 1, pool.getThreadCount(), chunks - 1 }) };
+    for (int i = 0; i < helpers; ++i)
+    {
+        pool.submit([state, work] {
+            {
+                std::lock_guard lock { state->mutex };
+                if (state->closed)
+                    return; // the caller already finished everything
+                ++state->running;
+            }
+
+            work();
+
+            std::lock_guard lock { state->mutex };
+            if (--state->running == 0)
+                state->finished.notify_all();
+        });
+    }
+
+    work();
+
+    std::exception_ptr error {};
+    {
+        std::unique_lock lock { state->mutex };
+        state->closed = true;
+        state->finished.wait(lock, [&] { return state->running == 0; });
+
+        // take the exception out, so a helper releasing the state last never touches it
+        error = std::move(state->error);
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// out[i] = f(in[i]), in cache-sized chunks spread over the pool
+template <typename T, typename F>
+void parallelTransform(ThreadPool& pool, DynamicArray<T>& out, const DynamicArray<T>& in, F f, const ParallelConfig& config = {})
+{
+    int grainSize { config.grainSize > 0 ? config.grainSize : std::max(1, ParallelConfig::defaultChunkBytes / static_cast<int>(sizeof(T))) };
+
+    parallelFor(pool, in.getLength(), grainSize, config, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            out[i] = f(in[i]);
+    });
+}
+
+// The MinMax from the arithmetic operator notes : operator+ keeps the smallest and the largest value seen
+class MinMax
+{
+private:
+    int m_min {};
+    int m_max {};
+
+public:
+    MinMax(int min, int max) : m_min { min }, m_max { max }
+    {
+    }
+
+    int getMin() const { return m_min; }
+    int getMax() const { return m_max; }
+
+    friend MinMax operator+(const MinMax& m1, const MinMax& m2)
+    {
+        return MinMax { std::min(m1.m_min, m2.m_min), std::max(m1.m_max, m2.m_max) };
+    }
+
+    friend MinMax operator+(const MinMax& m, int value)
+    {
+        return MinMax { std::min(m.m_min, value), std::max(m.m_max, value) };
+    }
+
+    friend bool operator==(const MinMax&, const MinMax&) = default;
+};
+
+template <typename T>
+struct SumMonoid
+{
+    using value_type = std::conditional_t<std::is_integral_v<T>, long long, T>;
+
+    value_type identity() const { return value_type {}; }
+    value_type combine(value_type a, value_type b) const { return a + b; }
+
+    value_type leaf(const T* first, const T* last) const
+    {
+        // 8 independent sums, so that the additions can go in SIMD lanes
+        value_type lanes[8] {};
+        for (; last - first >= 8; first += 8)
+            for (int lane = 0; lane < 8; ++lane)
+                lanes[lane] += first[lane];
+        for (int lane = 0; first != last; ++first, ++lane)
+            lanes[lane] += *first;
+
+        return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+};
+
+struct MinMaxMonoid
+{
+    using value_type = MinMax;
+
+    value_type identity() const { return MinMax { std::numeric_limits<int>::max(), std::numeric_limits<int>::min() }; }
+    value_type combine(const value_type& a, const value_type& b) const { return a + b; }
+
+    value_type leaf(const int* first, const int* last) const
+    {
+        int lows[8];
+        int highs[8];
+        std::fill_n(lows, 8, std::numeric_limits<int>::max());
+        std::fill_n(highs, 8, std::numeric_limits<int>::min());
+        for (; last - first >= 8; first += 8)
+        {
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                // written as compare and select, which SSE2 can do (it has no 32 bit min / max instruction)
+                lows[lane] = first[lane] < lows[lane] ? first[lane] : lows[lane];
+                highs[lane] = first[lane] > highs[lane] ? first[lane] : highs[lane];
+            }
+        }
+
+        MinMax result { *std::min_element(lows, lows + 8), *std::max_element(highs, highs + 8) };
+        for (; first != last; ++first)
+            result = result + *first;
+        return result;
+    }
+};
+
+// How many elements satisfy predicate
+template <typename T, typename Predicate>
+struct CountMonoid
+{
+    using value_type = long long;
+
+    Predicate predicate;
+
+    value_type identity() const { return 0; }
+    value_type combine(value_type a, value_type b) const { return a + b; }
+
+    value_type leaf(const T* first, const T* last) const
+    {
+        value_type count {};
+        for (; first != last; ++first)
+            count += predicate(*first) ? 1 : 0;
+        return count;
+    }
+};
+
+// Bins equal width bins over [low, high), values below low go to the first bin and values from high up to the last one
+template <int Bins>
+struct HistogramMonoid
+{
+    using value_type = std::array<long long, Bins>;
+
+    int m_low {};
+    int m_high {};
+
+    HistogramMonoid(int low, int high) : m_low { low }, m_high { high }
+    {
+        if (high <= low)
+            throw std::invalid_argument { "HistogramMonoid needs low < high" };
+    }
+
+    value_type identity() const { return value_type {}; }
+
+    value_type combine(const value_type& a, const value_type& b) const
+    {
+        value_type result {};
+        for (int bin = 0; bin < Bins; ++bin)
+            result[bin] = a[bin] + b[bin];
+        return result;
+    }
+
+    value_type leaf(const int* first, const int* last) const
+    {
+        value_type counts {};
+        double binsPerValue { static_cast<double>(Bins) / (static_cast<double>(m_high) - m_low) };
+        for (; first != last; ++first)
+        {
+            // outside values are sorted out before the conversion : (x - low) * binsPerValue may not fit in an int
+            int bin { 0 };
+            if (*first >= m_high)
+                bin = Bins - 1;
+            else if (*first > m_low)
+                bin = std::min(static_cast<int>((static_cast<double>(*first) - m_low) * binsPerValue), Bins - 1);
+            ++counts[bin];
+        }
+        return counts;
+    }
+};
+
+// A monoid made of an identity and a combine that also takes single elements, like MinMax's operator+
+template <typename V, typename Combine>
+struct FoldMonoid
+{
+    using value_type = V;
+
+    V m_identity;
+    Combine m_combine;
+
+    value_type identity() const { return m_identity; }
+    value_type combine(const value_type& a, const value_type& b) const { return m_combine(a, b); }
+
+    template <typename T>
+    value_type leaf(const T* first, const T* last) const
+    {
+        value_type result { m_identity };
+        for (; first != last; ++first)
+            result = m_combine(result, *first);
+        return result;
+    }
+};
+
+// Reduce arr with monoid, with the same grouping (so the same result) whatever the number of threads (see note 7)
+template <typename T, typename Monoid>
+typename Monoid::value_type parallelReduce(ThreadPool& pool, const DynamicArray<T>& arr, const Monoid& monoid, const ParallelConfig& config = {})
+{
+    using Value = typename Monoid::value_type;
+
+    int count { arr.getLength() };
+    if (count == 0)
+        return monoid.identity();
+
+    int grainSize { config.grainSize > 0 ? config.grainSize : std::max(1, ParallelConfig::defaultChunkBytes / static_cast<int>(sizeof(T))) };
+    int chunks { (count + grainSize - 1) / grainSize };
+    std::vector<Value> partials(static_cast<std::size_t>(chunks), monoid.identity());
+
+    // parallelFor over chunk numbers, with the cutoff converted from elements to chunks
+    ParallelConfig chunkConfig { config };
+    chunkConfig.sequentialCutoff = config.sequentialCutoff / grainSize;
+
+    const T* data { &arr[0] };
+    parallelFor(pool, chunks, 1, chunkConfig, [&](int firstChunk, int lastChunk) {
+        for (int chunk = firstChunk; chunk < lastChunk; ++chunk)
+        {
+            int begin { chunk * grainSize };
+            partials[chunk] = monoid.leaf(data + begin, data + std::min(count, begin + grainSize));
+        }
+    });
+
+    // fixed tree : neighbours, then neighbours of neighbours ...
+    for (int step = 1; step < chunks; step *= 2)
+        for (int i = 0; i + step < chunks; i += 2 * step)
+            partials[i] = monoid.combine(partials[i], partials[i + step]);
+
+    return partials[0];
+}
+
+template <typename T, typename V, typename Combine>
+V parallelReduce(ThreadPool& pool, const DynamicArray<T>& arr, V identity, Combine combine, const ParallelConfig& config = {})
+{
+    return parallelReduce(pool, arr, FoldMonoid<V, Combine> { identity, combine }, config);
+}
+
+// Return a copy of arr with all of the values doubled
+DynamicArray<int> cloneArrayAndDouble(const DynamicArray<int> &arr)
+{
+    DynamicArray<int> dbl(arr.getLength());
+    for (int i = 0; i < arr.getLength(); ++i)
+        dbl[i] = arr[i] * 2;
+
+    return dbl;
+}
+
+DynamicArray<int> cloneArrayAndDoubleParallel(ThreadPool& pool, const DynamicArray<int> &arr, const ParallelConfig& config = {})
+{
+    DynamicArray<int> dbl(arr.getLength());
+    parallelTransform(pool, dbl, arr, [](int x) { return x * 2; }, config);
+
+    return dbl;
+}
+
+int main()
+{
+    ThreadPool pool {};
+    std::cout << "Pool of " << pool.getThreadCount() << " worker thread(s) + the main thread\n";
+
+    for (int size : { 1000000, 50000000 })
+    {
+        DynamicArray<int> arr(size);
+        for (int i = 0; i < arr.getLength(); i++)
+            arr[i] = i;
+
+        Timer t;
+        DynamicArray<int> serial { cloneArrayAndDouble(arr) };
+        double serialNs { t.elapsed() };
+
+        t.reset();
+        DynamicArray<int> parallel { cloneArrayAndDoubleParallel(pool, arr) };
+        double parallelNs { t.elapsed() };
+
+        bool same { true };
+        for (int i = 0; i < size && same; ++i)
+            same = serial[i] == parallel[i];
+
+        std::cout << size << " elements : serial " << serialNs << " ns, parallel " << parallelNs << " ns"
+                  << (same ? "" : " (RESULTS DIFFER)") << '\n';
+    }
+
+    // exceptions thrown in a worker come back to the caller
+    DynamicArray<int> arr(1000000);
+    for (int i = 0; i < arr.getLength(); i++)
+        arr[i] = i;
+
+    try
+    {
+        DynamicArray<int> out(arr.getLength());
+        parallelTransform(pool, out, arr, [](int x) {
+            if (x == 765432)
+                throw std::runtime_error { "bad element" };
+            return x;
+        }, ParallelConfig{ 0, 4096, 0 });
+    }
+    catch (const std::exception& exception)
+    {
+        std::cout << "Caught: " << exception.what() << '\n';
+    }
+
+    // statistics over 50M ints
+    DynamicArray<int> values(50000000);
+    std::uint64_t seed { 7 };
+    for (int i = 0; i < values.getLength(); ++i)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        values[i] = static_cast<int>(seed >> 40) % 2000001 - 1000000;
+    }
+
+    // each statistic on its own : a plain loop vs parallelReduce
+    auto isMultipleOf7 = [](int x) { return x % 7 == 0; };
+    auto compare = [&](const char* name, auto serial, auto parallel) {
+        Timer t;
+        auto expected { serial() };
+        double serialNs { t.elapsed() };
+
+        t.reset();
+        auto result { parallel() };
+        double parallelNs { t.elapsed() };
+
+        std::cout << name << " of 50M ints : serial " << serialNs / 1e6 << " ms, parallelReduce " << parallelNs / 1e6 << " ms"
+                  << (result == expected ? "" : " (RESULTS DIFFER)") << '\n';
+    };
+
+    compare("sum    ", [&] {
+        long long sum {};
+        for (int i = 0; i < values.getLength(); ++i)
+            sum += values[i];
+        return sum;
+    }, [&] { return parallelReduce(pool, values, SumMonoid<int> {}); });
+
+    compare("min/max", [&] {
+        MinMax minMax { MinMaxMonoid {}.identity() };
+        for (int i = 0; i < values.getLength(); ++i)
+            minMax = minMax + values[i];
+        return minMax;
+    }, [&] { return parallelReduce(pool, values, MinMaxMonoid {}); });
+
+    compare("count  ", [&] {
+        long long count {};
+        for (int i = 0; i < values.getLength(); ++i)
+            count += isMultipleOf7(values[i]) ? 1 : 0;
+        return count;
+    }, [&] { return parallelReduce(pool, values, CountMonoid<int, decltype(isMultipleOf7)> { isMultipleOf7 }); });
+
+    // MinMax's own operator+ is enough to make a reduction
+    MinMax folded { parallelReduce(pool, values, MinMaxMonoid {}.identity(), std::plus<> {}) };
+    std::cout << "min " << folded.getMin() << ", max " << folded.getMax() << '\n';
+
+    HistogramMonoid<8> histogram { -1000000, 1000001 };
+    for (long long bin : parallelReduce(pool, values, histogram))
+        std::cout << bin << ' ';
+    std::cout << '\n';
+
+    try
+    {
+        HistogramMonoid<8> empty { 5, 5 };
+    }
+    catch (const std::invalid_argument& error)
+    {
+        std::cout << "Caught: " << error.what() << '\n';
+    }
+
+    // a float sum gives the same bits with any number of threads
+    DynamicArray<float> floats(values.getLength());
+    for (int i = 0; i < floats.getLength(); ++i)
+        floats[i] = static_cast<float>(values[i]) * 1e-3f;
+
+    float oneThread { parallelReduce(pool, floats, SumMonoid<float> {}, ParallelConfig { 1 }) };
+    bool reproducible { true };
+    for (int threads = 2; threads <= pool.getThreadCount() + 1; ++threads)
+        reproducible = reproducible && parallelReduce(pool, floats, SumMonoid<float> {}, ParallelConfig { threads }) == oneThread;
+
+    float serialFloat {};
+    for (int i = 0; i < floats.getLength(); ++i)
+        serialFloat += floats[i];
+    std::cout << "float sum : " << oneThread << (reproducible ? ", the same with every thread count" : ", CHANGES WITH THE THREAD COUNT")
+              << " (a plain serial loop gives " << serialFloat << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,455 @@
+#include <iostream>
+/*
+    Notes :
+
+    1. Why a profiler instead of printing Timer::elapsed() ?
+
+        - In the move semantics notes we measured code like this :
+
+            Timer t;
+            arr = cloneArrayAndDouble(arr);
+            std::cout << t.elapsed() << " ns\n";
+
+        - That works for one measurement of one block, but it cannot tell us how many times a function ran, what the slowest call was, or how the time is spread out. And printing from inside a hot loop costs far more than the code we are trying to measure.
+
+        - A scoped profiler keeps the measuring (cheap) separate from the reporting (expensive, done once at exit).
+
+    2. Named RAII regions :
+
+        - A ScopedTimer starts a Timer in its constructor and records the elapsed time in its destructor, so a region is simply a scope :
+
+            void cloneArrayAndDouble(...)
+            {
+                PROFILE_SCOPE("cloneArrayAndDouble");
+                ...
+            } // time recorded here, even if we return early or throw
+
+        - PROFILE_SCOPE creates one static ProfileRegion per call site (the name is registered only once), so entering the scope does no lookup by name. Regions are intentionally leaked : static objects are destroyed in reverse order of construction, so a region created after reportAtExit() would otherwise be gone by the time the report runs.
+
+    3. Per-thread lock-free accumulation :
+
+        - If every thread added into the same counters, they would fight over the same cache line (or over a mutex). Instead every thread gets its own ProfileSlot per region, created the first time the thread enters that region (the only time a lock is taken).
+
+        - A slot has exactly one writer (its thread), so updates are plain relaxed atomic loads and stores, no read-modify-write and no lock. The report thread reads the slots with relaxed loads and sums them.
+
+        - Slots are owned by the region, not by the thread, so the numbers survive after the thread exits.
+
+    4. Log-bucketed latency histogram :
+
+        - We cannot keep every sample, but we want percentiles (p50, p99, p99.9). Each slot counts samples in buckets whose width grows with the value : for every power of two there are 4 sub-buckets, so any sample lands in a bucket no more than 25% wider than the sample itself.
+
+            bucket = 4 * (floor(log2(ns)) - 1) + the 2 bits after the leading 1     (values 0..3 get a bucket each)
+
+        - 64 powers of two * 4 sub-buckets = 256 counters, enough for any 64-bit nanosecond value. A percentile is found by walking the merged buckets until the running count reaches p * calls, and reporting that bucket's upper bound.
+
+    5. Reporting :
+
+        - Profiler::report(std::cout, ReportFormat::text) prints a table; ReportFormat::json prints a machine readable array. Profiler::reportAtExit() registers the report with std::atexit so the program doesn't have to remember to call it.
+
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>       // for std::snprintf
+#include <cstdlib>      // for std::atexit
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+// One thread's counters for one region. Only the owning thread writes to it.
+class ProfileSlot
+{
+public:
+    static constexpr int subBucketBits { 2 };
+    static constexpr int bucketCount { 64 << subBucketBits };
+
+    std::atomic<std::uint64_t> calls {};
+    std::atomic<std::uint64_t> totalNs {};
+    std::atomic<std::uint64_t> minNs { std::numeric_limits<std::uint64_t>::max() };
+    std::atomic<std::uint64_t> maxNs {};
+    std::array<std::atomic<std::uint64_t>, bucketCount> buckets {};
+
+    static int bucketOf(std::uint64_t ns)
+    {
+        if (ns < (1u << subBucketBits))
+            return static_cast<int>(ns);
+
+        int log2 { 63 - __builtin_clzll(ns) };
+        int sub { static_cast<int>((ns >> (log2 - subBucketBits)) & ((1u << subBucketBits) - 1)) };
+        return ((log2 - subBucketBits + 1) << subBucketBits) + sub;
+    }
+
+    // largest value that falls into bucket
+    static std::uint64_t upperBoundOf(int bucket)
+    {
+        if (bucket < (1 << subBucketBits))
+            return static_cast<std::uint64_t>(bucket);
+
+        int log2 { (bucket >> subBucketBits) + subBucketBits - 1 };
+        std::uint64_t sub { static_cast<std::uint64_t>(bucket & ((1 << subBucketBits) - 1)) };
+        std::uint64_t low { (std::uint64_t{ 1 } << log2) | (sub << (log2 - subBucketBits)) };
+        return low + (std::uint64_t{ 1 } << (log2 - subBucketBits)) - 1;
+    }
+
+    // single writer : load + store is enough, no atomic read-modify-write needed
+    void record(std::uint64_t ns)
+    {
+        constexpr auto relaxed { std::memory_order_relaxed };
+
+        calls.store(calls.load(relaxed) + 1, relaxed);
+        totalNs.store(totalNs.load(relaxed) + ns, relaxed);
+        if (ns < minNs.load(relaxed))
+            minNs.store(ns, relaxed);
+        if (ns > maxNs.load(relaxed))
+            maxNs.store(ns, relaxed);
+
+        auto& bucket { buckets[bucketOf(ns)] };
+        bucket.store(bucket.load(relaxed) + 1, relaxed);
+    }
+};
+
+// Totals of all the slots of a region, computed when reporting
+struct ProfileStats
+{
+    std::string name {};
+    std::uint64_t calls {};
+    std::uint64_t totalNs {};
+    std::uint64_t minNs {};
+    std::uint64_t maxNs {};
+    std::uint64_t p50Ns {};
+    std::uint64_t p99Ns {};
+    std::uint64_t p999Ns {};
+
+    double meanNs() const { return calls ? static_cast<double>(totalNs) / calls : 0.0; }
+};
+
+class ProfileRegion
+{
+    std::string m_name {};
+    std::mutex m_mutex {};
+    std::vector<std::unique_ptr<ProfileSlot>> m_slots {};
+
+public:
+    explicit ProfileRegion(std::string name);
+
+    ProfileRegion(const ProfileRegion&) = delete;
+    ProfileRegion& operator=(const ProfileRegion&) = delete;
+
+    // called once per thread per region, the only place a lock is taken
+    ProfileSlot& registerThread()
+    {
+        std::lock_guard lock { m_mutex };
+        m_slots.push_back(std::make_unique<ProfileSlot>());
+        return *m_slots.back();
+    }
+
+    ProfileStats stats()
+    {
+        constexpr auto relaxed { std::memory_order_relaxed };
+
+        ProfileStats result { m_name };
+        std::array<std::uint64_t, ProfileSlot::bucketCount> merged {};
+        std::uint64_t minNs { std::numeric_limits<std::uint64_t>::max() };
+
+        std::lock_guard lock { m_mutex };
+        for (const auto& slot : m_slots)
+        {
+            result.calls += slot->calls.load(relaxed);
+            result.totalNs += slot->totalNs.load(relaxed);
+            minNs = std::min(minNs, slot->minNs.load(relaxed));
+            result.maxNs = std::max(result.maxNs, slot->maxNs.load(relaxed));
+            for (int i = 0; i < ProfileSlot::bucketCount; ++i)
+                merged[i] += slot->buckets[i].load(relaxed);
+        }
+
+        if (result.calls == 0)
+            return result;
+
+        result.minNs = minNs;
+        result.p50Ns = percentile(merged, result.calls, 0.5);
+        result.p99Ns = percentile(merged, result.calls, 0.99);
+        result.p999Ns = percentile(merged, result.calls, 0.999);
+
+        // the histogram only knows bucket bounds, never report outside the real range
+        for (auto* p : { &result.p50Ns, &result.p99Ns, &result.p999Ns })
+            *p = std::clamp(*p, result.minNs, result.maxNs);
+
+        return result;
+    }
+
+private:
+    static std::uint64_t percentile(const std::array<std::uint64_t, ProfileSlot::bucketCount>& buckets, std::uint64_t calls, double p)
+    {
+        std::uint64_t rank { static_cast<std::uint64_t>(p * static_cast<double>(calls - 1)) + 1 };
+        std::uint64_t seen {};
+        for (int i = 0; i < ProfileSlot::bucketCount; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+                return ProfileSlot::upperBoundOf(i);
+        }
+        return ProfileSlot::upperBoundOf(ProfileSlot::bucketCount - 1);
+    }
+};
+
+enum class ReportFormat
+{
+    text,
+    json,
+};
+
+class Profiler
+{
+    std::mutex m_mutex {};
+    std::vector<ProfileRegion*> m_regions {};
+
+    Profiler() = default;
+
+public:
+    static Profiler& instance()
+    {
+        static Profiler profiler {};
+        return profiler;
+    }
+
+    void add(ProfileRegion& region)
+    {
+        std::lock_guard lock { m_mutex };
+        m_regions.push_back(&region);
+    }
+
+    static void report(std::ostream& out, ReportFormat format = ReportFormat::text)
+    {
+        std::vector<ProfileStats> all {};
+        {
+            Profiler& profiler { instance() };
+            std::lock_guard lock { profiler.m_mutex };
+            for (auto* region : profiler.m_regions)
+                all.push_back(region->stats());
+        }
+
+        std::sort(all.begin(), all.end(), [](const auto& a, const auto& b) { return a.totalNs > b.totalNs; });
+
+        if (format == ReportFormat::json)
+            printJson(out, all);
+        else
+            printText(out, all);
+    }
+
+    // Print the report when the program exits (after main returns)
+    static void reportAtExit(ReportFormat format = ReportFormat::text)
+    {
+        static ReportFormat s_format {};
+        s_format = format;
+        instance(); // construct the profiler before registering, so it outlives the handler
+
+        std::atexit([] { report(std::cout, s_format); });
+    }
+
+private:
+    static void printText(std::ostream& out, const std::vector<ProfileStats>& all)
+    {
+        out << "region                               calls    total(ms)    mean(ns)   min(ns)   p50(ns)   p99(ns)  p999(ns)   max(ns)\n";
+        for (const auto& s : all)
+        {
+            std::string name { s.name.substr(0, 32) };
+            name.resize(32, ' ');
+
+            char line[256];
+            std::snprintf(line, sizeof(line), "%s %9llu %12.3f %11.1f %9llu %9llu %9llu %9llu %9llu\n",
+                name.c_str(),
+                static_cast<unsigned long long>(s.calls), s.totalNs / 1e6, s.meanNs(),
+                static_cast<unsigned long long>(s.minNs), static_cast<unsigned long long>(s.p50Ns),
+                static_cast<unsigned long long>(s.p99Ns), static_cast<unsigned long long>(s.p999Ns),
+                static_cast<unsigned long long>(s.maxNs));
+            out << line;
+        }
+    }
+
+    static void printJson(std::ostream& out, const std::vector<ProfileStats>& all)
+    {
+        out << "[\n";
+        for (std::size_t i = 0; i < all.size(); ++i)
+        {
+            const auto& s { all[i] };
+            out << "  { \"name\": \"" << s.name << "\""
+                << ", \"calls\": " << s.calls
+                << ", \"total_ns\": " << s.totalNs
+                << ", \"mean_ns\": " << s.meanNs()
+                << ", \"min_ns\": " << s.minNs
+                << ", \"p50_ns\": " << s.p50Ns
+                << ", \"p99_ns\": " << s.p99Ns
+                << ", \"p999_ns\": " << s.p999Ns
+                << ", \"max_ns\": " << s.maxNs << " }"
+                << (i + 1 < all.size() ? ",\n" : "\n");
+        }
+        out << "]\n";
+    }
+};
+
+ProfileRegion::ProfileRegion(std::string name)
+    : m_name{ std::move(name) }
+{
+    Profiler::instance().add(*this);
+}
+
+// RAII : times the enclosing scope with a Timer and records it into the thread's slot
+class ScopedTimer
+{
+    ProfileSlot& m_slot;
+    Timer m_timer {};
+
+public:
+    explicit ScopedTimer(ProfileSlot& slot) : m_slot{ slot } {}
+
+    ~ScopedTimer()
+    {
+        m_slot.record(static_cast<std::uint64_t>(m_timer.elapsed()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// One region per call site, one slot per thread, one timer per entry.
+// The region is deliberately never destroyed, so the report at exit can still read it.
+#define PROFILE_SCOPE(name)                                                                                  \
+    static ProfileRegion& PROFILE_CONCAT(profileRegion_, __LINE__) { *new ProfileRegion{ name } };           \
+    thread_local ProfileSlot& PROFILE_CONCAT(profileSlot_, __LINE__) {                                       \
+        PROFILE_CONCAT(profileRegion_, __LINE__).registerThread() };                                         \
+    ScopedTimer PROFILE_CONCAT(profileTimer_, __LINE__) { PROFILE_CONCAT(profileSlot_, __LINE__) }
+
+// The fixed size DynamicArray from Move Semantics and Smart Pointers/003_moveConstructorAndAssignment.cpp
+template <typename T>
+class DynamicArray
+{
+    T * _arr;
+    int _len;
+
+    public:
+
+    DynamicArray(int size) : _arr{new T[size]} , _len{size}
+    {
+
+    }
+
+    ~DynamicArray()
+    {
+        delete [] _arr;
+    }
+
+    DynamicArray(const DynamicArray& copy) = delete;
+    DynamicArray& operator=(const DynamicArray &copy) = delete;
+
+    DynamicArray(DynamicArray &&copy) noexcept
+    : _arr{copy._arr} , _len{copy._len}
+    {
+        copy._len = 0;
+        copy._arr = nullptr;
+    }
+
+    DynamicArray & operator=(DynamicArray && copy) noexcept
+    {
+        if(this == &copy)
+        {
+            return *this;
+        }
+
+        delete [] _arr;
+        _len = copy._len;
+        _arr = copy._arr;
+        copy._len = 0;
+        copy._arr = nullptr;
+
+        return *this;
+    }
+
+    int getLength() const
+    {
+        return _len;
+    }
+
+    T & operator[](int index)
+    {
+        return _arr[index];
+    }
+
+    const T & operator[](int index) const
+    {
+        return _arr[index];
+    }
+};
+
+// Return a copy of arr with all of the values doubled, timed in blocks of 4096 elements
+DynamicArray<int> cloneArrayAndDouble(const DynamicArray<int> &arr)
+{
+    PROFILE_SCOPE("cloneArrayAndDouble");
+
+    DynamicArray<int> dbl(arr.getLength());
+    for (int begin = 0; begin < arr.getLength(); begin += 4096)
+    {
+        PROFILE_SCOPE("cloneArrayAndDouble/block");
+
+        int end { std::min(begin + 4096, arr.getLength()) };
+        for (int i = begin; i < end; ++i)
+            dbl[i] = arr[i] * 2;
+    }
+
+    return dbl;
+}
+
+int main()
+{
+    Profiler::reportAtExit(ReportFormat::text);
+
+    DynamicArray<int> arr(1000000);
+    {
+        PROFILE_SCOPE("fill");
+        for (int i = 0; i < arr.getLength(); i++)
+            arr[i] = i;
+    }
+
+    // the same region is entered from several threads, each gets its own slot
+    std::vector<std::thread> workers {};
+    for (int t = 0; t < 4; ++t)
+    {
+        workers.emplace_back([&arr] {
+            for (int run = 0; run < 10; ++run)
+                DynamicArray<int> dbl { cloneArrayAndDouble(arr) };
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    Profiler::report(std::cout, ReportFormat::json);
+
+    return 0;
+} // the text report is printed here, by the std::atexit handler
@@ -0,0 +1,713 @@
+#include <iostream>
+/*
+    Notes :
+
+    1. Why SIMD kernels for DynamicArray ?
+
+        - cloneArrayAndDouble from the move semantics notes is a scalar loop : one multiply per iteration.
+
+            for (int i = 0; i < arr.getLength(); ++i)
+                dbl[i] = arr[i] * 2;
+
+        - SIMD (single instruction, multiple data) registers hold several elements at once. One instruction works on all of them :
+
+            = SSE2    : 128 bit registers ->  4 int/float,  2 double
+            = AVX2    : 256 bit registers ->  8 int/float,  4 double
+            = AVX-512 : 512 bit registers -> 16 int/float,  8 double
+
+        - So the same loop can process 4, 8 or 16 elements per iteration, with a short scalar loop for the left over "tail".
+
+    2. Runtime dispatch :
+
+        - Every x86-64 CPU has SSE2, but AVX2 and AVX-512 depend on the machine the program runs on. If we compile the whole program with -mavx2 it crashes (illegal instruction) on older CPUs.
+
+        - Instead each kernel is compiled several times, once per instruction set, and the right one is picked once at startup by asking the CPU (CPUID, through GCC/Clang's __builtin_cpu_supports, which also checks that the OS saves the wider registers).
+
+        - "#pragma GCC target(...)" enables an instruction set only for the functions defined between push_options and pop_options, including templates. That is why the kernel bodies are written once in the SIMD_DEFINE_KERNELS macro and expanded inside each instruction set's namespace : the same source, compiled three times with different targets.
+
+        - The chosen kernels are stored in a table of function pointers (TransformKernels<T>), filled once, so each call costs one indirect call, not one CPU check.
+
+    3. Bit-identical results :
+
+        - A faster kernel is useless if it gives different answers depending on the machine. All the kernels produce exactly the same bits as the scalar loop :
+
+            = int arithmetic wraps around (the scalar path does the math in unsigned, where overflow is defined)
+            = fused multiply-add rounds once, so the scalar path uses std::fma, never a * b + c (which rounds twice). SSE2 has no FMA instruction, so the SSE2 float/double fma kernel falls back to the scalar loop rather than giving different bits.
+            = clamp is written as "lo > x ? lo : x" then "hi < t ? hi : t", which is exactly what the max/min instructions do (including for NaN and -0.0)
+
+    4. The kernels :
+
+            simd::map(out, in, f)            out[i] = f(in[i])     (compiled per target, vectorized by the compiler at -O3)
+            simd::scale(out, in, k)          out[i] = in[i] * k
+            simd::add(out, a, b)             out[i] = a[i] + b[i]
+            simd::fma(out, a, b, c)          out[i] = a[i] * b[i] + c[i]
+            simd::clamp(out, in, lo, hi)     out[i] = std::clamp(in[i], lo, hi)
+
+        - Build with optimizations, e.g. g++ -std=c++20 -O3 simdKernels.cpp. No -mavx2 is needed.
+
+    5. How much faster ?
+
+        - While the data fits in the cache, AVX-512 doubles 16 ints per instruction instead of 1 (or 4, when the compiler auto-vectorizes the plain loop for SSE2), and the kernel is several times faster.
+
+        - A 1,000,000 element int array is 4 MB to read plus 4 MB to write. Past the L2 cache the loop waits on memory, not on arithmetic, and wider registers help much less. For those sizes, splitting the work over several cores (more memory bandwidth) matters more than the instruction set.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>        // for std::fma
+#include <cstring>      // for std::memcmp
+#include <random>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+// The fixed size DynamicArray from Move Semantics and Smart Pointers/003_moveConstructorAndAssignment.cpp,
+// plus data() so the kernels can work on the raw elements
+template <typename T>
+class DynamicArray
+{
+    T * _arr;
+    int _len;
+
+    public:
+
+    DynamicArray(int size) : _arr{new T[size]} , _len{size}
+    {
+
+    }
+
+    ~DynamicArray()
+    {
+        delete [] _arr;
+    }
+
+    DynamicArray(const DynamicArray& copy) = delete;
+    DynamicArray& operator=(const DynamicArray &copy) = delete;
+
+    DynamicArray(DynamicArray &&copy) noexcept
+    : _arr{copy._arr} , _len{copy._len}
+    {
+        copy._len = 0;
+        copy._arr = nullptr;
+    }
+
+    DynamicArray & operator=(DynamicArray && copy) noexcept
+    {
+        if(this == &copy)
+        {
+            return *this;
+        }
+
+        delete [] _arr;
+        _len = copy._len;
+        _arr = copy._arr;
+        copy._len = 0;
+        copy._arr = nullptr;
+
+        return *this;
+    }
+
+    int getLength() const
+    {
+        return _len;
+    }
+
+    T * data() { return _arr; }
+    const T * data() const { return _arr; }
+
+    T & operator[](int index)
+    {
+        return _arr[index];
+    }
+
+    const T & operator[](int index) const
+    {
+        return _arr[index];
+    }
+};
+
+namespace simd
+{
+    enum class SimdLevel
+    {
+        scalar,
+        sse2,
+        avx2,
+        avx512,
+    };
+
+    const char* getName(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SimdLevel::scalar: return "scalar";
+        case SimdLevel::sse2:   return "sse2";
+        case SimdLevel::avx2:   return "avx2";
+        case SimdLevel::avx512: return "avx512";
+        }
+        return "???";
+    }
+
+    SimdLevel detectSimdLevel()
+    {
+#if SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return SimdLevel::avx512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return SimdLevel::avx2;
+        if (__builtin_cpu_supports("sse2"))
+            return SimdLevel::sse2;
+#endif
+        return SimdLevel::scalar;
+    }
+
+    // The reference semantics every kernel must reproduce bit for bit (see note 3)
+    namespace scalar
+    {
+        template <typename T>
+        T addOf(T a, T b)
+        {
+            if constexpr (std::is_integral_v<T>)
+                return static_cast<T>(static_cast<std::make_unsigned_t<T>>(a) + static_cast<std::make_unsigned_t<T>>(b));
+            else
+                return a + b;
+        }
+
+        template <typename T>
+        T mulOf(T a, T b)
+        {
+            if constexpr (std::is_integral_v<T>)
+                return static_cast<T>(static_cast<std::make_unsigned_t<T>>(a) * static_cast<std::make_unsigned_t<T>>(b));
+            else
+                return a * b;
+        }
+
+        template <typename T>
+        T fmaOf(T a, T b, T c)
+        {
+            if constexpr (std::is_integral_v<T>)
+                return addOf(mulOf(a, b), c);
+            else
+                return std::fma(a, b, c);
+        }
+
+        template <typename T>
+        T clampOf(T x, T lo, T hi)
+        {
+            T t { lo > x ? lo : x };
+            return hi < t ? hi : t;
+        }
+
+        template <typename T>
+        void scale(T* out, const T* in, int n, T k)
+        {
+            for (int i = 0; i < n; ++i)
+                out[i] = mulOf(in[i], k);
+        }
+
+        template <typename T>
+        void add(T* out, const T* a, const T* b, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                out[i] = addOf(a[i], b[i]);
+        }
+
+        template <typename T>
+        void fma(T* out, const T* a, const T* b, const T* c, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                out[i] = fmaOf(a[i], b[i], c[i]);
+        }
+
+        template <typename T>
+        void clamp(T* out, const T* in, int n, T lo, T hi)
+        {
+            for (int i = 0; i < n; ++i)
+                out[i] = clampOf(in[i], lo, hi);
+        }
+
+        template <typename T, typename F>
+        void map(T* out, const T* in, int n, F f)
+        {
+            for (int i = 0; i < n; ++i)
+                out[i] = f(in[i]);
+        }
+    }
+
+// Kernel bodies shared by every instruction set. Each expansion needs, in its namespace :
+// width<T>, hasExactFma<T>, and load/store/set1/add/mul/fmadd/max/min overloads for the vector types.
+#define SIMD_DEFINE_KERNELS                                                                 \
+    template <typename T>                                                                   \
+    void scale(T* out, const T* in, int n, T k)                                             \
+    {                                                                                       \
+        auto kv { set1(k) };                                                                \
+        int i { 0 };                                                                        \
+        for (; i + width<T> <= n; i += width<T>)                                            \
+            store(out + i, mul(load(in + i), kv));                                          \
+        scalar::scale(out + i, in + i, n - i, k);                                           \
+    }                                                                                       \
+                                                                                            \
+    template <typename T>                                                                   \
+    void add(T* out, const T* a, const T* b, int n)                                         \
+    {                                                                                       \
+        int i { 0 };                                                                        \
+        for (; i + width<T> <= n; i += width<T>)                                            \
+            store(out + i, add(load(a + i), load(b + i)));                                  \
+        scalar::add(out + i, a + i, b + i, n - i);                                          \
+    }                                                                                       \
+                                                                                            \
+    template <typename T>                                                                   \
+    void fma(T* out, const T* a, const T* b, const T* c, int n)                             \
+    {                                                                                       \
+        int i { 0 };                                                                        \
+        if constexpr (hasExactFma<T>)                                                       \
+        {                                                                                   \
+            for (; i + width<T> <= n; i += width<T>)                                        \
+                store(out + i, fmadd(load(a + i), load(b + i), load(c + i)));               \
+        }                                                                                   \
+        scalar::fma(out + i, a + i, b + i, c + i, n - i);                                   \
+    }                                                                                       \
+                                                                                            \
+    template <typename T>                                                                   \
+    void clamp(T* out, const T* in, int n, T lo, T hi)                                      \
+    {                                                                                       \
+        auto lov { set1(lo) };                                                              \
+        auto hiv { set1(hi) };                                                              \
+        int i { 0 };                                                                        \
+        for (; i + width<T> <= n; i += width<T>)                                            \
+            store(out + i, min(hiv, max(lov, load(in + i))));                               \
+        scalar::clamp(out + i, in + i, n - i, lo, hi);                                      \
+    }                                                                                       \
+                                                                                            \
+    template <typename T, typename F>                                                       \
+    void map(T* out, const T* in, int n, F f)                                               \
+    {                                                                                       \
+        for (int i = 0; i < n; ++i)                                                         \
+            out[i] = f(in[i]);                                                              \
+    }
+
+#if SIMD_X86
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+    namespace sse2
+    {
+        template <typename T>
+        constexpr int width { 16 / sizeof(T) };
+
+        // SSE2 has no fused multiply-add, only integers can be done exactly
+        template <typename T>
+        constexpr bool hasExactFma { std::is_integral_v<T> };
+
+        inline __m128i load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        inline __m128 load(const float* p) { return _mm_loadu_ps(p); }
+        inline __m128d load(const double* p) { return _mm_loadu_pd(p); }
+
+        inline void store(int* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        inline void store(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+        inline void store(double* p, __m128d v) { _mm_storeu_pd(p, v); }
+
+        inline __m128i set1(int x) { return _mm_set1_epi32(x); }
+        inline __m128 set1(float x) { return _mm_set1_ps(x); }
+        inline __m128d set1(double x) { return _mm_set1_pd(x); }
+
+        inline __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+        inline __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+        inline __m128d add(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+
+        // SSE2 has no 32 bit multiply (that is SSE4.1), so multiply the even and odd lanes as 64 bit and keep the low halves
+        inline __m128i mul(__m128i a, __m128i b)
+        {
+            __m128i even { _mm_mul_epu32(a, b) };
+            __m128i odd { _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)) };
+            return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        }
+        inline __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+        inline __m128d mul(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+
+        inline __m128i fmadd(__m128i a, __m128i b, __m128i c) { return add(mul(a, b), c); }
+
+        // max(a, b) = a > b ? a : b and min(a, b) = a < b ? a : b, like the float instructions
+        inline __m128i max(__m128i a, __m128i b)
+        {
+            __m128i greater { _mm_cmpgt_epi32(a, b) };
+            return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+        }
+        inline __m128 max(__m128 a, __m128 b) { return _mm_max_ps(a, b); }
+        inline __m128d max(__m128d a, __m128d b) { return _mm_max_pd(a, b); }
+
+        inline __m128i min(__m128i a, __m128i b)
+        {
+            __m128i less { _mm_cmpgt_epi32(b, a) };
+            return _mm_or_si128(_mm_and_si128(less, a), _mm_andnot_si128(less, b));
+        }
+        inline __m128 min(__m128 a, __m128 b) { return _mm_min_ps(a, b); }
+        inline __m128d min(__m128d a, __m128d b) { return _mm_min_pd(a, b); }
+
+        SIMD_DEFINE_KERNELS
+    }
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+    namespace avx2
+    {
+        template <typename T>
+        constexpr int width { 32 / sizeof(T) };
+
+        template <typename T>
+        constexpr bool hasExactFma { true };
+
+        inline __m256i load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        inline __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+        inline __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+
+        inline void store(int* p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+        inline void store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+        inline void store(double* p, __m256d v) { _mm256_storeu_pd(p, v); }
+
+        inline __m256i set1(int x) { return _mm256_set1_epi32(x); }
+        inline __m256 set1(float x) { return _mm256_set1_ps(x); }
+        inline __m256d set1(double x) { return _mm256_set1_pd(x); }
+
+        inline __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+        inline __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+        inline __m256d add(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+
+        inline __m256i mul(__m256i a, __m256i b) { return _mm256_mullo_epi32(a, b); }
+        inline __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+        inline __m256d mul(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+
+        inline __m256i fmadd(__m256i a, __m256i b, __m256i c) { return add(mul(a, b), c); }
+        inline __m256 fmadd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+        inline __m256d fmadd(__m256d a, __m256d b, __m256d c) { return _mm256_fmadd_pd(a, b, c); }
+
+        inline __m256i max(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+        inline __m256 max(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+        inline __m256d max(__m256d a, __m256d b) { return _mm256_max_pd(a, b); }
+
+        inline __m256i min(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+        inline __m256 min(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+        inline __m256d min(__m256d a, __m256d b) { return _mm256_min_pd(a, b); }
+
+        SIMD_DEFINE_KERNELS
+    }
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized" // false positive inside GCC 12's own avx512fintrin.h
+    namespace avx512
+    {
+        template <typename T>
+        constexpr int width { 64 / sizeof(T) };
+
+        template <typename T>
+        constexpr bool hasExactFma { true };
+
+        inline __m512i load(const int* p) { return _mm512_loadu_si512(p); }
+        inline __m512 load(const float* p) { return _mm512_loadu_ps(p); }
+        inline __m512d load(const double* p) { return _mm512_loadu_pd(p); }
+
+        inline void store(int* p, __m512i v) { _mm512_storeu_si512(p, v); }
+        inline void store(float* p, __m512 v) { _mm512_storeu_ps(p, v); }
+        inline void store(double* p, __m512d v) { _mm512_storeu_pd(p, v); }
+
+        inline __m512i set1(int x) { return _mm512_set1_epi32(x); }
+        inline __m512 set1(float x) { return _mm512_set1_ps(x); }
+        inline __m512d set1(double x) { return _mm512_set1_pd(x); }
+
+        inline __m512i add(__m512i a, __m512i b) { return _mm512_add_epi32(a, b); }
+        inline __m512 add(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+        inline __m512d add(__m512d a, __m512d b) { return _mm512_add_pd(a, b); }
+
+        inline __m512i mul(__m512i a, __m512i b) { return _mm512_mullo_epi32(a, b); }
+        inline __m512 mul(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+        inline __m512d mul(__m512d a, __m512d b) { return _mm512_mul_pd(a, b); }
+
+        inline __m512i fmadd(__m512i a, __m512i b, __m512i c) { return add(mul(a, b), c); }
+        inline __m512 fmadd(__m512 a, __m512 b, __m512 c) { return _mm512_fmadd_ps(a, b, c); }
+        inline __m512d fmadd(__m512d a, __m512d b, __m512d c) { return _mm512_fmadd_pd(a, b, c); }
+
+        inline __m512i max(__m512i a, __m512i b) { return _mm512_max_epi32(a, b); }
+        inline __m512 max(__m512 a, __m512 b) { return _mm512_max_ps(a, b); }
+        inline __m512d max(__m512d a, __m512d b) { return _mm512_max_pd(a, b); }
+
+        inline __m512i min(__m512i a, __m512i b) { return _mm512_min_epi32(a, b); }
+        inline __m512 min(__m512 a, __m512 b) { return _mm512_min_ps(a, b); }
+        inline __m512d min(__m512d a, __m512d b) { return _mm512_min_pd(a, b); }
+
+        SIMD_DEFINE_KERNELS
+    }
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+#endif // SIMD_X86
+
+    // One set of kernels for one element type and one instruction set
+    template <typename T>
+    struct TransformKernels
+    {
+        void (*scale)(T* out, const T* in, int n, T k);
+        void (*add)(T* out, const T* a, const T* b, int n);
+        void (*fma)(T* out, const T* a, const T* b, const T* c, int n);
+        void (*clamp)(T* out, const T* in, int n, T lo, T hi);
+    };
+
+    template <typename T>
+    TransformKernels<T> getKernels(SimdLevel level)
+    {
+        static_assert(std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>,
+            "simd kernels are provided for int, float and double");
+
+        switch (level)
+        {
+#if SIMD_X86
+        case SimdLevel::avx512: return { avx512::scale<T>, avx512::add<T>, avx512::fma<T>, avx512::clamp<T> };
+        case SimdLevel::avx2:   return { avx2::scale<T>, avx2::add<T>, avx2::fma<T>, avx2::clamp<T> };
+        case SimdLevel::sse2:   return { sse2::scale<T>, sse2::add<T>, sse2::fma<T>, sse2::clamp<T> };
+#endif
+        default:                return { scalar::scale<T>, scalar::add<T>, scalar::fma<T>, scalar::clamp<T> };
+        }
+    }
+
+    SimdLevel getSimdLevel()
+    {
+        static const SimdLevel s_level { detectSimdLevel() };
+        return s_level;
+    }
+
+    // The kernels for this CPU, selected the first time they are needed
+    template <typename T>
+    const TransformKernels<T>& getKernels()
+    {
+        static const TransformKernels<T> s_kernels { getKernels<T>(getSimdLevel()) };
+        return s_kernels;
+    }
+
+    template <typename T>
+    void scale(DynamicArray<T>& out, const DynamicArray<T>& in, T k)
+    {
+        assert(out.getLength() == in.getLength());
+        getKernels<T>().scale(out.data(), in.data(), in.getLength(), k);
+    }
+
+    template <typename T>
+    void add(DynamicArray<T>& out, const DynamicArray<T>& a, const DynamicArray<T>& b)
+    {
+        assert(out.getLength() == a.getLength() && a.getLength() == b.getLength());
+        getKernels<T>().add(out.data(), a.data(), b.data(), a.getLength());
+    }
+
+    template <typename T>
+    void fma(DynamicArray<T>& out, const DynamicArray<T>& a, const DynamicArray<T>& b, const DynamicArray<T>& c)
+    {
+        assert(out.getLength() == a.getLength() && a.getLength() == b.getLength() && b.getLength() == c.getLength());
+        getKernels<T>().fma(out.data(), a.data(), b.data(), c.data(), a.getLength());
+    }
+
+    template <typename T>
+    void clamp(DynamicArray<T>& out, const DynamicArray<T>& in, T lo, T hi)
+    {
+        assert(out.getLength() == in.getLength());
+        getKernels<T>().clamp(out.data(), in.data(), in.getLength(), lo, hi);
+    }
+
+    // f is a template parameter, so it can't go into the function pointer table : dispatch per call instead
+    template <typename T, typename F>
+    void map(DynamicArray<T>& out, const DynamicArray<T>& in, F f)
+    {
+        assert(out.getLength() == in.getLength());
+        switch (getSimdLevel())
+        {
+#if SIMD_X86
+        case SimdLevel::avx512: avx512::map(out.data(), in.data(), in.getLength(), f); return;
+        case SimdLevel::avx2:   avx2::map(out.data(), in.data(), in.getLength(), f); return;
+        case SimdLevel::sse2:   sse2::map(out.data(), in.data(), in.getLength(), f); return;
+#endif
+        default:                scalar::map(out.data(), in.data(), in.getLength(), f); return;
+        }
+    }
+}
+
+// Return a copy of arr with all of the values doubled
+DynamicArray<int> cloneArrayAndDouble(const DynamicArray<int> &arr)
+{
+    DynamicArray<int> dbl(arr.getLength());
+    for (int i = 0; i < arr.getLength(); ++i)
+        dbl[i] = arr[i] * 2;
+
+    return dbl;
+}
+
+// Same result, using the fastest kernel this CPU supports
+DynamicArray<int> cloneArrayAndDoubleSimd(const DynamicArray<int> &arr)
+{
+    DynamicArray<int> dbl(arr.getLength());
+    simd::scale(dbl, arr, 2);
+
+    return dbl;
+}
+
+// The loop from cloneArrayAndDouble on its own. noinline keeps the benchmark below
+// from hoisting the repeated work out of its loop.
+__attribute__((noinline)) void doubleLoop(int* out, const int* in, int n)
+{
+    for (int i = 0; i < n; ++i)
+        out[i] = in[i] * 2;
+}
+
+template <typename T>
+void fillRandom(DynamicArray<T>& arr, std::mt19937& rng)
+{
+    for (int i = 0; i < arr.getLength(); ++i)
+    {
+        if constexpr (std::is_integral_v<T>)
+            arr[i] = static_cast<T>(rng());
+        else
+            arr[i] = std::uniform_real_distribution<T>{ -1000, 1000 }(rng);
+    }
+}
+
+template <typename T>
+bool sameBits(const DynamicArray<T>& a, const DynamicArray<T>& b)
+{
+    return std::memcmp(a.data(), b.data(), sizeof(T) * a.getLength()) == 0;
+}
+
+// Run every kernel at every level this CPU supports and compare the bits with the scalar kernels
+template <typename T>
+bool checkBitIdentical(const char* typeName)
+{
+    constexpr int n { 1003 }; // not a multiple of any vector width, so the tails are tested too
+    std::mt19937 rng { 42 };
+
+    DynamicArray<T> a(n), b(n), c(n), expected(n), actual(n);
+    fillRandom(a, rng);
+    fillRandom(b, rng);
+    fillRandom(c, rng);
+
+    auto reference { simd::getKernels<T>(simd::SimdLevel::scalar) };
+    bool ok { true };
+
+    for (auto level : { simd::SimdLevel::sse2, simd::SimdLevel::avx2, simd::SimdLevel::avx512 })
+    {
+        if (level > simd::getSimdLevel())
+            break;
+
+        auto kernels { simd::getKernels<T>(level) };
+        auto check = [&](const char* kernel) {
+            if (!sameBits(expected, actual))
+            {
+                std::cout << typeName << ' ' << kernel << " differs at " << simd::getName(level) << '\n';
+                ok = false;
+            }
+        };
+
+        reference.scale(expected.data(), a.data(), n, T(3));
+        kernels.scale(actual.data(), a.data(), n, T(3));
+        check("scale");
+
+        reference.add(expected.data(), a.data(), b.data(), n);
+        kernels.add(actual.data(), a.data(), b.data(), n);
+        check("add");
+
+        reference.fma(expected.data(), a.data(), b.data(), c.data(), n);
+        kernels.fma(actual.data(), a.data(), b.data(), c.data(), n);
+        check("fma");
+
+        reference.clamp(expected.data(), a.data(), n, T(-100), T(100));
+        kernels.clamp(actual.data(), a.data(), n, T(-100), T(100));
+        check("clamp");
+    }
+
+    return ok;
+}
+
+template <typename F>
+double bestOf(int runs, F f)
+{
+    double best {};
+    for (int run = 0; run < runs; ++run)
+    {
+        Timer t;
+        f();
+        double ns { t.elapsed() };
+        if (run == 0 || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+int main()
+{
+    std::cout << "Using " << simd::getName(simd::getSimdLevel()) << " kernels\n";
+
+    bool ok { checkBitIdentical<int>("int") };
+    ok = checkBitIdentical<float>("float") && ok;
+    ok = checkBitIdentical<double>("double") && ok;
+    std::cout << (ok ? "All kernels match the scalar results bit for bit\n" : "MISMATCH\n");
+
+    DynamicArray<int> arr(1000000);
+    for (int i = 0; i < arr.getLength(); i++)
+        arr[i] = i;
+
+    DynamicArray<int> dbl(arr.getLength());
+
+    // 1000000 ints is 4 MB per array : mostly limited by memory bandwidth.
+    // 4096 ints fit in the L1 cache, which shows what the instructions themselves cost.
+    for (int n : { 1000000, 4096 })
+    {
+        int repeat { 1000000 / n };
+        double scalarNs { bestOf(20, [&] {
+            for (int r = 0; r < repeat; ++r)
+                doubleLoop(dbl.data(), arr.data(), n);
+        }) };
+        double simdNs { bestOf(20, [&] {
+            for (int r = 0; r < repeat; ++r)
+                simd::getKernels<int>().scale(dbl.data(), arr.data(), n, 2);
+        }) };
+
+        std::cout << "double " << n << " ints x " << repeat << ", loop : " << scalarNs << " ns, "
+                  << simd::getName(simd::getSimdLevel()) << " : " << simdNs << " ns\n";
+    }
+
+    // the clone from the move semantics notes, both ways
+    DynamicArray<int> slow { cloneArrayAndDouble(arr) };
+    DynamicArray<int> fast { cloneArrayAndDoubleSimd(arr) };
+    std::cout << "cloneArrayAndDouble results " << (sameBits(slow, fast) ? "match" : "differ") << '\n';
+
+    // map takes any function, and is compiled once per instruction set
+    simd::map(dbl, arr, [](int x) { return x / 3 + 1; });
+    std::cout << "map(x / 3 + 1)[999999] = " << dbl[999999] << '\n';
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+#include <iostream>
+/*
+    Notes :
+
+    1. Why intern strings ?
+
+        - Teacher, Doctor, Patient, Car, Employee, Person ... all of them own a std::string m_name. With a million employees, the same few thousand first and last names are stored again and again : a std::string is 32 bytes, plus a heap block for anything longer than 15 characters.
+
+        - Comparing two names means comparing their characters, and hashing one means reading all of them.
+
+        - Interning keeps one copy of each distinct string in a pool, and gives back a small id. Objects store the id (InternedString, 4 bytes) :
+
+            = equal strings always get the same id, so a == b is an integer compare, and the hash is the id.
+            = view() gives back the characters as a std::string_view, which stays valid until the program ends (strings are never removed from the pool).
+
+    2. The pool :
+
+        - The characters live in an arena : big blocks (64 KB) that strings are copied into one after the other, so there is no heap allocation and no allocation header per string.
+
+        - Thread safety through sharding : the pool is split in 16 shards by the hash of the string, each with its own std::shared_mutex, and its own map from string to id. Interning a string that is already there only takes the shard's lock in shared mode, so that is what most calls do, in parallel.
+
+        - An id is the shard number (4 bits) and an index in the shard (28 bits). Going from id to string does not take any lock : each shard has a table of string_views split in chunks of 65536 entries, and a chunk never moves once allocated (unlike a std::vector, which moves everything when it grows).
+
+        - Ids are not in alphabetical order, so InternedString has ==, but no < (compare the view()s to sort by name).
+
+    3. The empty string is interned up front with id 0, so a default constructed InternedString is "".
+
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Timer
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Nanosecond = std::chrono::duration<double, std::nano>;
+
+    std::chrono::time_point<Clock> _begin { Clock::now() };
+
+public:
+    void reset()
+    {
+        _begin = Clock::now();
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration_cast<Nanosecond>(Clock::now() - _begin).count();
+    }
+};
+
+class InternPool
+{
+    static constexpr int shardBits { 4 };
+    static constexpr int shardCount { 1 << shardBits };
+    static constexpr int indexBits { 32 - shardBits };
+    static constexpr int chunkBits { 16 };
+    static constexpr std::uint32_t chunkSize { 1u << chunkBits };
+    static constexpr int chunkCount { 1 << (indexBits - chunkBits) };
+    static constexpr std::size_t blockSize { 64 * 1024 };
+
+    struct alignas(64) Shard
+    {
+        std::shared_mutex m_mutex {};
+        std::unordered_map<std::string_view, std::uint32_t> m_ids {};    // keys point into the arena
+        std::array<std::atomic<std::string_view*>, chunkCount> m_chunks {};
+        std::uint32_t m_count {};
+
+        // the arena
+        std::vector<std::unique_ptr<char[]>> m_blocks {};
+        char* m_next { nullptr };
+        std::size_t m_left {};
+        std::size_t m_bytes {};
+
+        ~Shard()
+        {
+            for (auto& chunk : m_chunks)
+                delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        std::string_view copyToArena(std::string_view text)
+        {
+            if (text.size() > m_left)
+            {
+                std::size_t size { std::max(blockSize, text.size()) };
+                m_blocks.push_back(std::make_unique<char[]>(size));
+                m_next = m_blocks.back().get();
+                m_left = size;
+            }
+
+            if (text.empty())
+                return {};
+
+            std::memcpy(m_next, text.data(), text.size());
+            std::string_view copy { m_next, text.size() };
+            m_next += text.size();
+            m_left -= text.size();
+            m_bytes += text.size();
+
+            return copy;
+        }
+    };
+
+    std::array<Shard, shardCount> m_shards {};
+
+    InternPool()
+    {
+        intern(""); // id 0
+    }
+
+    static int shardOf(std::string_view text)
+    {
+        // the top bits, the low ones are what the shard's map uses
+        return static_cast<int>(std::hash<std::string_view>{}(text) >> (sizeof(std::size_t) * 8 - shardBits));
+    }
+
+public:
+    InternPool(const InternPool&) = delete;
+    InternPool& operator=(const InternPool&) = delete;
+
+    static InternPool& instance()
+    {
+        static InternPool pool {};
+        return pool;
+    }
+
+    std::uint32_t intern(std::string_view text)
+    {
+        int shardIndex { text.empty() ? 0 : shardOf(text) };
+        Shard& shard { m_shards[shardIndex] };
+
+        {
+            std::shared_lock lock { shard.m_mutex };
+            if (auto it { shard.m_ids.find(text) }; it != shard.m_ids.end())
+                return it->second;
+        }
+
+        std::unique_lock lock { shard.m_mutex };
+        if (auto it { shard.m_ids.find(text) }; it != shard.m_ids.end())
+            return it->second; // another thread got there first
+
+        std::uint32_t index { shard.m_count };
+        if (index >= (1u << indexBits))
+            throw std::length_error { "InternPool shard is full" };
+
+        std::atomic<std::string_view*>& chunkSlot { shard.m_chunks[index >> chunkBits] };
+        std::string_view* chunk { chunkSlot.load(std::memory_order_relaxed) };
+        if (!chunk)
+        {
+            chunk = new std::string_view[chunkSize];
+            chunkSlot.store(chunk, std::memory_order_release);
+        }
+
+        std::string_view copy { shard.copyToArena(text) };
+        chunk[index & (chunkSize - 1)] = copy;
+        ++shard.m_count;
+
+        std::uint32_t id { (static_cast<std::uint32_t>(shardIndex) << indexBits) | index };
+        shard.m_ids.emplace(copy, id);
+
+        return id;
+    }
+
+    // no lock : the id came from intern(), so its entry is written already
+    std::string_view view(std::uint32_t id) const
+    {
+        const Shard& shard { m_shards[id >> indexBits] };
+        std::uint32_t index { id & ((1u << indexBits) - 1) };
+        return shard.m_chunks[index >> chunkBits].load(std::memory_order_acquire)[index & (chunkSize - 1)];
+    }
+
+    std::size_t getCount()
+    {
+        std::size_t count {};
+        for (Shard& shard : m_shards)
+        {
+            std::shared_lock lock { shard.m_mutex };
+            count += shard.m_count;
+        }
+        return count;
+    }
+
+    std::size_t getStringBytes()
+    {
+        std::size_t bytes {};
+        for (Shard& shard : m_shards)
+        {
+            std::shared_lock lock { shard.m_mutex };
+            bytes += shard.m_bytes;
+        }
+        return bytes;
+    }
+};
+
+class InternedString
+{
+    std::uint32_t m_id {};
+
+public:
+    InternedString() = default;
+
+    InternedString(std::string_view text) : m_id { InternPool::instance().intern(text) }
+    {
+    }
+
+    std::string_view view() const { return InternPool::instance().view(m_id); }
+    std::string str() const { return std::string { view() }; }
+    std::uint32_t getId() const { return m_id; }
+
+    friend bool operator==(InternedString a, InternedString b) { return a.m_id == b.m_id; }
+
+    friend std::ostream& operator<<(std::ostream& out, InternedString text)
+    {
+        out << text.view();
+        return out;
+    }
+};
+
+template <>
+struct std::hash<InternedString>
+{
+    std::size_t operator()(InternedString text) const noexcept { return text.getId(); }
+};
+
+// An Employee as the OOP chapters write it, and the same with an interned name
+class Employee
+{
+    std::string m_name {};
+    int m_id {};
+
+public:
+    Employee(std::string_view name, int id) : m_name { name }, m_id { id }
+    {
+    }
+
+    const std::string& getName() const { return m_name; }
+    int getId() const { return m_id; }
+};
+
+class InternedEmployee
+{
+    InternedString m_name {};
+    int m_id {};
+
+public:
+    InternedEmployee(InternedString name, int id) : m_name { name }, m_id { id }
+    {
+    }
+
+    InternedString getName() const { return m_name; }
+    int getId() const { return m_id; }
+};
+
+int main()
+{
+    InternedString a { "Lucy Ricardo" };
+    InternedString b { std::string { "Lucy " } + "Ricardo" };
+    std::cout << a << " == " << b << " : " << (a == b) << " (id " << a.getId() << "), empty id : " << InternedString {}.getId() << '\n';
+
+    // 1000000 employees named from 100 first names x 100 last names
+    std::vector<std::string> fullNames {};
+    for (int first = 0; first < 100; ++first)
+        for (int last = 0; last < 100; ++last)
+            fullNames.push_back("Firstname" + std::to_string(first) + " Lastname" + std::to_string(last));
+
+    constexpr int employeeCount { 1000000 };
+    std::vector<Employee> employees {};
+    employees.reserve(employeeCount);
+    for (int i = 0; i < employeeCount; ++i)
+        employees.emplace_back(fullNames[(i * 7919u) % fullNames.size()], i);
+
+    // intern from 4 threads at once
+    std::vector<InternedEmployee> interned(employeeCount, InternedEmployee { InternedString {}, 0 });
+    Timer t;
+    std::vector<std::thread> threads {};
+    for (int part = 0; part < 4; ++part)
+    {
+        threads.emplace_back([&, part] {
+            for (int i = part; i < employeeCount; i += 4)
+                interned[i] = InternedEmployee { InternedString { employees[i].getName() }, i };
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    std::cout << "Interned " << employeeCount << " names from 4 threads : " << t.elapsed() / 1e6 << " ms, "
+              << InternPool::instance().getCount() << " distinct\n";
+
+    std::size_t stringBytes {};
+    for (const Employee& employee : employees)
+        stringBytes += sizeof(std::string) + (employee.getName().capacity() > 15 ? employee.getName().capacity() + 1 : 0);
+    std::size_t internedBytes { interned.size() * sizeof(InternedString) + InternPool::instance().getStringBytes() };
+    std::cout << "Name memory : std::string " << stringBytes / 1024 << " KB, InternedString " << internedBytes / 1024 << " KB (+ the pool's maps)\n";
+
+    // how many employees share a name
+    const std::string& wanted { fullNames[42] };
+    t.reset();
+    int count {};
+    for (const Employee& employee : employees)
+        count += employee.getName() == wanted;
+    std::cout << "Count by std::string     : " << t.elapsed() / 1e6 << " ms (" << count << ")\n";
+
+    InternedString wantedId { wanted };
+    t.reset();
+    count = 0;
+    for (const InternedEmployee& employee : interned)
+        count += employee.getName() == wantedId;
+    std::cout << "Count by InternedString  : " << t.elapsed() / 1e6 << " ms (" << count << ")\n";
+
+    return 0;
+}
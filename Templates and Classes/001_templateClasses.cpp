@@ -169,10 +169,19 @@
 
     This method may be more efficient (depending on how your compiler and linker handle templates and duplicate definitions), but requires maintaining the templates.cpp file for each program.
 
+    7. Template containers and memory resources : Array<T> below gets its memory from a std::pmr::memory_resource* instead of new T[]. Because the resource is a run time pointer and not a template parameter, Array<int> on the heap and Array<int> in an arena are still the same type.
+
+        - Since resource->allocate() only returns raw bytes, the elements are created with std::uninitialized_default_construct_n and destroyed with std::destroy_n, which is what new T[] and delete[] were doing for us.
+
+            std::pmr::unsynchronized_pool_resource pool;
+            Array<double> values(100, &pool); // freed blocks go back to the pool for reuse
+
 
 */
 
 #include <cassert>
+#include <memory> // for std::uninitialized_default_construct_n, std::destroy_n
+#include <memory_resource>
 
 template <typename T>
 class Array
@@ -181,10 +190,23 @@ class Array
 
     int _size{};
     T * _data{};
+    std::pmr::memory_resource * _resource{};
 
     public:
 
-    Array(int length) : _size{length}, _data{new T[length]}{}
+    Array(int length, std::pmr::memory_resource * resource = std::pmr::get_default_resource())
+    : _size{length}, _data{static_cast<T*>(resource->allocate(sizeof(T) * length, alignof(T)))}, _resource{resource}
+    {
+        try
+        {
+            std::uninitialized_default_construct_n(_data, _size);
+        }
+        catch (...)
+        {
+            _resource->deallocate(_data, sizeof(T) * _size, alignof(T));
+            throw;
+        }
+    }
 
     Array(const Array &other) = delete;
 
@@ -197,7 +219,11 @@ class Array
 
     void erase()
     {
-        delete [] _data;
+        if (_data)
+        {
+            std::destroy_n(_data, _size);
+            _resource->deallocate(_data, sizeof(T) * _size, alignof(T));
+        }
         _data = nullptr;
         _size = 0;
     }
@@ -222,5 +248,11 @@ int main()
     Array<int> intArr(10);
 
     std::cout<<intArr[1]<<std::endl;
+
+    std::pmr::unsynchronized_pool_resource pool;
+    Array<double> values(100, &pool);
+    values[99] = 3.5;
+
+    std::cout<<values[99]<<std::endl;
     return 0;
 }
\ No newline at end of file